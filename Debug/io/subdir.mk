@@ -5,9 +5,12 @@
 # Add inputs and outputs from these tool invocations to the build variables 
 CPP_SRCS += \
 ../io/convert.cpp \
+../io/gorilla.cpp \
+../io/iobinarydatafile.cpp \
 ../io/ioconfigfile.cpp \
 ../io/iodatafile.cpp \
 ../io/iodirectory.cpp \
+../io/iomappeddatafile.cpp \
 ../io/iofile.cpp \
 ../io/iooption.cpp \
 ../io/iosectionkeyfile.cpp \
@@ -15,9 +18,12 @@ CPP_SRCS += \
 
 OBJS += \
 ./io/convert.o \
+./io/gorilla.o \
+./io/iobinarydatafile.o \
 ./io/ioconfigfile.o \
 ./io/iodatafile.o \
 ./io/iodirectory.o \
+./io/iomappeddatafile.o \
 ./io/iofile.o \
 ./io/iooption.o \
 ./io/iosectionkeyfile.o \
@@ -25,9 +31,12 @@ OBJS += \
 
 CPP_DEPS += \
 ./io/convert.d \
+./io/gorilla.d \
+./io/iobinarydatafile.d \
 ./io/ioconfigfile.d \
 ./io/iodatafile.d \
 ./io/iodirectory.d \
+./io/iomappeddatafile.d \
 ./io/iofile.d \
 ./io/iooption.d \
 ./io/iosectionkeyfile.d \
@@ -38,7 +47,7 @@ CPP_DEPS += \
 io/%.o: ../io/%.cpp io/subdir.mk
 	@echo 'Building file: $<'
 	@echo 'Invoking: GCC C++ Compiler'
-	g++ -std=c++17 -O0 -g3 -Wall -c -fmessage-length=0 -MMD -MP -MF"$(@:%.o=%.d)" -MT"$@" -o "$@" "$<"
+	g++ -std=c++17 -O0 -g3 -Wall -c -mavx2 -ffp-contract=off -fmessage-length=0 -MMD -MP -MF"$(@:%.o=%.d)" -MT"$@" -o "$@" "$<"
 	@echo 'Finished building: $<'
 	@echo ' '
 
@@ -4,5 +4,5 @@
 
 USER_OBJS :=
 
-LIBS := -lserial -larmadillo
+LIBS := -lserial -larmadillo -lpthread
 
@@ -14,6 +14,7 @@ from scipy import signal
 import sys
 from scipy.signal import lfilter, lfilter_zi
 import shutil
+from resultstore import ResultStore, quat_rows_to_euler, split_times
 
 #diff_max = [0.125, 0.25, 0.5, 1, 2]
 diff_max = [0.125, 5]
@@ -44,14 +45,33 @@ def writeToFile(folder, iteration, data, param1, param2):
         f.write("%s\n" % param2)
     return 0
     
-def testConvergence(folderIn):
+# quatResult files of runs with --quat-only are converted to Euler angles on reading,
+# returns the rows and their times, the last column of decimated rows
+def readEulerFile(filename):
+    rows = []
+    with open(filename, 'r') as csvfile:
+        plots = csv.reader(csvfile, delimiter=',')
+        for row in plots:
+            rows.append([float(value) for value in row if value != ''])
+    if len(rows) > 0 and len(rows[0]) >= 17:
+        rows = quat_rows_to_euler(np.array(rows, dtype=np.float64))
+    else:
+        rows = np.array(rows, dtype=np.float64)
+        rows = rows.reshape(-1, rows.shape[1] if rows.size > 0 else 13)
+    return split_times(rows, 13)
+
+# folderIn is an eulerResult folder or, if a result store is given, a dataset of it
+def testConvergence(folderIn, store=None):
     time_axis = []
     # the filter size has to be a even number in order to get an odd number of samples to filter
     filter_size = 10
     
     iteration = str(folderIn[-4:])
     
-    filelist = sorted( filter( os.path.isfile, glob.glob(folderIn + '/*.csv') ) )
+    if store is None:
+        filelist = sorted( filter( os.path.isfile, glob.glob(folderIn + '/*.csv') ) )
+    else:
+        filelist = range(len(store.betas(folderIn)))
 #    filelist = [folderIn + "/0000.csv", folderIn + "/0001.csv", folderIn + "/0002.csv", folderIn + "/0003.csv", folderIn + "/0004.csv"]
 #    filelist = [folderIn + "/0018.csv"]
 
@@ -71,44 +91,30 @@ def testConvergence(folderIn):
     
     for filename_ea in (filelist):
         print ("filename", filename_ea)
-        xT = []
-        yT = []
-        zT = []
+        if store is None:
+            rows, times = readEulerFile(filename_ea)
+        else:
+            # mapped from the store, no text is parsed
+            rows = store.euler(folderIn, filename_ea)
+            times = store.times(folderIn)
+
+        xT = rows[:,0]
+        yT = rows[:,1]
+        zT = rows[:,2]
         #mdw
-        xM = []
-        yM = []
-        zM = []
+        xM = rows[:,3]
+        yM = rows[:,4]
+        zM = rows[:,5]
         #wilson
-        xW = []
-        yW = []
-        zW = []
+        xW = rows[:,6]
+        yW = rows[:,7] # - for MDW2
+        zW = rows[:,8] # - for MDW2
         #QGD
-        xQ = []
-        yQ = []
-        zQ = []
-            
-        beta = []
-        
-        with open(filename_ea, 'r') as csvfile:
-            plots = csv.reader(csvfile, delimiter=',')
-            for row in plots:
-                xT.append(float(row[0])) 
-                yT.append(float(row[1]))
-                zT.append(float(row[2]))
-                
-                xM.append(float(row[3]))
-                yM.append(float(row[4]))
-                zM.append(float(row[5]))
-                
-                xW.append(float(row[6]))
-                yW.append(float(row[7])) # - for MDW2 
-                zW.append(float(row[8])) # - for MDW2
-                
-                xQ.append(float(row[9]))
-                yQ.append(float(row[10]))
-                zQ.append(float(row[11])) 
-                
-                beta.append(float(row[12]))
+        xQ = rows[:,9]
+        yQ = rows[:,10]
+        zQ = rows[:,11]
+
+        beta = rows[:,12]
     
         n_size = len(xM)
         data = np.zeros((n_size,12), dtype=np.float64)
@@ -139,7 +145,7 @@ def testConvergence(folderIn):
         time_axis.clear()
         
         for l in range(n_size):
-            time_axis.append(0.01*l)
+            time_axis.append(times[l])
     
         #############################################################################################
         ########## Difference from the true value of the respective algorithms ######################
@@ -176,13 +182,13 @@ def testConvergence(folderIn):
             for j in range(diff.shape[1]):
                 for i in reversed(range(diff.shape[0])):
                     if(abs(diff[-1,j] - diff[i,j]) > diff_max[k]):
-                        convergence[num_file,j] = round(float(i)*0.01,1)
+                        convergence[num_file,j] = round(float(times[i]),1)
                         break
        
             for j in range(diff.shape[1]):
                 for i in reversed(range(diff.shape[0])):
                     if(diff_filtered[i,j] > diff_max[k]):
-                        convergence_true[num_file,j] = round(float(i)*0.01,1)
+                        convergence_true[num_file,j] = round(float(times[i]),1)
                         break
 
             writeToFile(convergence_folders[k], iteration, convergence[num_file,:], diff_max[k], beta[0])
@@ -196,6 +202,13 @@ if __name__ == '__main__':
     convergence_folders = makeFolders(folderOut, "convergence_", diff_max)
     convergence_true_folder = makeFolders(folderOut, "convergence_true_", diff_max)
     
-    iteration = str(folderIn[-4:])
-    print("Iteration", iteration)
-    testConvergence(folderIn)
\ No newline at end of file
+    # a result store holds all datasets of a sweep
+    if os.path.isfile(folderIn):
+        store = ResultStore(folderIn)
+        for dataset in store.datasets():
+            print("Iteration", dataset[-4:])
+            testConvergence(dataset, store)
+    else:
+        iteration = str(folderIn[-4:])
+        print("Iteration", iteration)
+        testConvergence(folderIn)
\ No newline at end of file
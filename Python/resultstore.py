@@ -0,0 +1,141 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+Reading the binary result store written by qgd --result-store <file>
+
+Any (dataset, beta, algorithm) block is mapped with numpy.memmap, nothing
+is parsed or copied until it is used. The true orientation is stored once
+per dataset, its index entries of all beta values refer to the same block
+and it is joined with the blocks of a beta value on reading. So are the
+times of the rows, which are not 0.01 s apart once the rows are decimated.
+The layout is described in tools/common/resultstore.hpp.
+
+@author: hristinaradak95@gmail.com
+"""
+
+import numpy as np
+
+MAGIC = b'QGDRES01'
+
+HEADER = np.dtype([('magic', 'S8'), ('version', '<u4'), ('entry_size', '<u4'),
+                   ('num_columns', '<u8'), ('index_offset', '<u8'),
+                   ('num_entries', '<u8'), ('reserved', 'V24')])
+
+ENTRY = np.dtype([('dataset', 'S32'), ('beta', '<f8'), ('beta_index', '<u4'),
+                  ('algorithm', '<u4'), ('num_rows', '<u8'), ('offset', '<u8')])
+
+TRUE, MADGWICK, WILSON, QGD = range(4)
+ALGORITHMS = ['true', 'madgwick', 'wilson', 'qgd']
+# the index entry of the times of the rows of a dataset, version 2 and later
+TIME = 4
+SAMPLE_TIME = 0.01
+COLUMNS = ['s', 'v1', 'v2', 'v3', 'roll', 'pitch', 'yaw']
+QUAT = slice(0, 4)
+EULER = slice(4, 7)
+
+def quat_to_euler(quat):
+    """roll, pitch and yaw in degrees of the conjugates of an array of
+    quaternions of shape (4, n), the way runFusions converts them"""
+    s, v1, v2, v3 = quat[0], quat[1], quat[2], quat[3]
+    ss = s * s - 0.5
+    euler = np.empty((3, quat.shape[1]), dtype=np.float64)
+    euler[0] = np.arctan2(v2 * v3 + s * v1, ss + v3 * v3)
+    euler[1] = -np.arcsin(2 * (v1 * v3 - s * v2))
+    euler[2] = np.arctan2(v1 * v2 + s * v3, ss + v1 * v1)
+    euler *= 180 / np.pi
+    return euler
+
+def quat_rows_to_euler(rows):
+    """the rows of a quatResult CSV file converted to the rows of the
+    eulerResult file they replace, the time column of decimated rows is
+    kept"""
+    blocks = [quat_to_euler(rows[:, 4 * a:4 * a + 4].T)
+              for a in range(len(ALGORITHMS))]
+    return np.vstack(blocks + [rows[:, 16:].T]).T
+
+def split_times(rows, num_columns):
+    """the rows of a result CSV file of num_columns columns and the times of
+    the rows in seconds, taken from the last column if the rows are
+    decimated"""
+    if rows.shape[1] > num_columns:
+        return rows[:, :num_columns], rows[:, num_columns]
+    return rows, np.arange(rows.shape[0]) * SAMPLE_TIME
+
+class ResultStore:
+    def __init__(self, filename):
+        self.filename = filename
+        header = np.fromfile(filename, dtype=HEADER, count=1)
+        if len(header) != 1 or header[0]['magic'] != MAGIC:
+            raise ValueError("not a result store: " + filename)
+        header = header[0]
+        self.num_columns = int(header['num_columns'])
+        self.index = np.memmap(filename, dtype=ENTRY, mode='r',
+                               offset=int(header['index_offset']),
+                               shape=(int(header['num_entries']),))
+
+    def datasets(self):
+        """the datasets in the order they were run"""
+        names = []
+        for name in self.index['dataset']:
+            if name.decode() not in names:
+                names.append(name.decode())
+        return names
+
+    def betas(self, dataset):
+        """the beta values of a dataset by beta index, rounded to the 6
+        decimals of the result CSV files (stores written before the C++ side
+        rounded them hold e.g. 0.30000000000000004)"""
+        entries = self.index[(self.index['dataset'] == dataset.encode())
+                             & (self.index['algorithm'] == TRUE)]
+        return np.round(entries['beta'], 6)
+
+    def columns(self, dataset, beta_index, algorithm):
+        """the block of an algorithm as array of shape (num_columns, num_rows)"""
+        entries = self.index[(self.index['dataset'] == dataset.encode())
+                             & (self.index['beta_index'] == beta_index)
+                             & (self.index['algorithm'] == algorithm)]
+        if len(entries) == 0:
+            raise KeyError((dataset, beta_index, algorithm))
+        entry = entries[-1]
+        return np.memmap(self.filename, dtype='<f8', mode='r',
+                         offset=int(entry['offset']),
+                         shape=(self.num_columns, int(entry['num_rows'])))
+
+    def times(self, dataset):
+        """the times of the rows of a dataset in seconds"""
+        entries = self.index[(self.index['dataset'] == dataset.encode())
+                             & (self.index['algorithm'] == TIME)]
+        if len(entries) == 0:
+            num_rows = int(self.truth(dataset).shape[1])
+            return np.arange(num_rows) * SAMPLE_TIME
+        entry = entries[-1]
+        return np.memmap(self.filename, dtype='<f8', mode='r',
+                         offset=int(entry['offset']),
+                         shape=(int(entry['num_rows']),))
+
+    def truth(self, dataset):
+        """the block of the true orientation, the same for all beta values"""
+        return self.columns(dataset, 0, TRUE)
+
+    def euler(self, dataset, beta_index):
+        """the Euler angles of a beta value the way the eulerResult CSV files
+        hold them: roll, pitch, yaw of true, Madgwick, Wilson and QGD, beta.
+        Stores written with --quat-only get them converted on demand."""
+        if self.num_columns > EULER.start:
+            blocks = [self.columns(dataset, beta_index, a)[EULER]
+                      for a in range(len(ALGORITHMS))]
+        else:
+            blocks = [quat_to_euler(self.columns(dataset, beta_index, a)[QUAT])
+                      for a in range(len(ALGORITHMS))]
+        beta = self.betas(dataset)[beta_index]
+        rows = np.vstack(blocks + [np.full((1, blocks[0].shape[1]), beta)])
+        return rows.T
+
+    def quat(self, dataset, beta_index):
+        """the quaternions of a beta value the way the quatResult CSV files
+        hold them: s, v1, v2, v3 of true, Madgwick, Wilson and QGD, beta"""
+        blocks = [self.columns(dataset, beta_index, a)[QUAT]
+                  for a in range(len(ALGORITHMS))]
+        beta = self.betas(dataset)[beta_index]
+        rows = np.vstack(blocks + [np.full((1, blocks[0].shape[1]), beta)])
+        return rows.T
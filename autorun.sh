@@ -8,10 +8,8 @@ BASEDIR_QUAT_RESULTS="quatResult"
 # ***** delete previous results *****
 #rm -rf $DIR_RESULTS/*
 
-# ***** run fusion with sense *****
-for file in ExampleData/*cfg; do
-    echo $file
-    ./qgd -c $file
+# ***** run fusion with sense on all configuration files in one process *****
+./qgd -j "$DIR_EXAMPLE_DATA/*cfg"
 
 pwd
 
@@ -26,4 +24,3 @@ pwd
 # ***** plot results *****
 #python3 plot.py
 
-done
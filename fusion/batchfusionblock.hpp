@@ -0,0 +1,356 @@
+/**############################################################################
+#
+# Description: Many instances of a fusion algorithm run in lock-step
+#
+#
+# Copyright (C) 2024 by Hristina Radak
+#
+# Email: hristinaradak95@gmail.com
+#
+###############################################################################
+# The Madgwick original, the Wilson and the QGD-OE fusion algorithm of
+# Madgwick1FusionBlock, WilsonFusionBlock and QuaternionGradientDescentBlock
+# for any number of lanes, each lane with a beta value and an orientation of
+# its own. The lanes are kept as structure of arrays and are advanced by a
+# sample at a time, SimdPack::WIDTH lanes per instruction. The sample of a
+# lane may be shared with the other lanes, as the ones of a beta sweep, or be
+# of a recording of its own, as long as all recordings are of equal length.
+#############################################################################*/
+
+#ifndef __BATCHFUSIONBLOCK_H
+#define __BATCHFUSIONBLOCK_H
+
+/**############################################################################
+# INCLUDES
+#############################################################################*/
+
+#include <algorithm>
+#include <vector>
+
+#include "../tools/quaternion/quaternion.hpp"
+#include "./simdpack.hpp"
+
+/**############################################################################
+# CLASS DECLARATIONS
+#############################################################################*/
+
+/******************************************************************************
+ *****************************************************************************/
+class BatchFusionBlock {
+public:
+	/** the fusion algorithms **************************************************/
+	enum Algorithm {MADGWICK, WILSON, QGD};
+
+	/** the lanes are run in groups of LANE_GROUP lanes, a multiple of the
+	 * width of any SimdPack **************************************************/
+	static const size_t LANE_GROUP = 8;
+
+private:
+	Algorithm algorithm_;
+	size_t numLanes_;
+
+	/** the orientations, beta values and magnetic references of the lanes,
+	 * padded to whole lane groups ********************************************/
+	std::vector<double> qw_, qx_, qy_, qz_;
+	std::vector<double> beta_;
+	std::vector<double> magRefX_, magRefZ_;
+
+	/** the latest sample of the lanes, acc and mag normalized *****************/
+	std::vector<double> gw_, gx_, gy_, gz_;
+	std::vector<double> ax_, ay_, az_;
+	std::vector<double> mx_, my_, mz_;
+
+	/****************************************************************************
+	 * normalize the quaternion (w, x, y, z) unless it is zero
+	 ***************************************************************************/
+	static void normalize(double &w, double &x, double &y, double &z)
+	{
+		double norm = std::sqrt(w * w + (x * x + y * y + z * z));
+		if (norm != 0) {
+			w /= norm;
+			x /= norm;
+			y /= norm;
+			z /= norm;
+		}
+	}
+
+	/****************************************************************************
+	 * the gradient of the upper branch of the pack of lanes starting at lane
+	 ***************************************************************************/
+	void gradientMadgwick(const size_t lane, const SimdPack &w, const SimdPack &x,
+			const SimdPack &y, const SimdPack &z, SimdPack grad[4]) const
+	{
+		SimdPack ax = SimdPack::load(&ax_[lane]), ay = SimdPack::load(&ay_[lane]),
+				az = SimdPack::load(&az_[lane]);
+		SimdPack mx = SimdPack::load(&mx_[lane]), my = SimdPack::load(&my_[lane]),
+				mz = SimdPack::load(&mz_[lane]);
+		SimdPack bx = SimdPack::load(&magRefX_[lane]),
+				bz = SimdPack::load(&magRefZ_[lane]);
+
+		/** difference equations ************************************************/
+		SimdPack fa0 = (w*y - x*z) * 2.0 - ax;
+		SimdPack fa1 = (-w*x - y*z) * 2.0 - ay;
+		SimdPack fa2 = -w*w + x*x + y*y - z*z - az;
+
+		SimdPack fm0 = (w*w + x*x - y*y - z*z) * bx + (-w*y - x*z) * bz - mx;
+		SimdPack fm1 = (-w*z + x*y) * bx + (w*x + y*z) * bz - my;
+		SimdPack fm2 = (w*y + x*z) * bx + (w*w - x*x - y*y + z*z) * bz - mz;
+
+		/** the Jacobian of the magnetic field, that of gravity is Wilson's ******/
+		SimdPack j00 = (bx*w - bz*y) * 2.0;
+		SimdPack j01 = (-bx*z + bz*x) * 2.0;
+		SimdPack j02 = (bx*y + bz*w) * 2.0;
+		SimdPack j10 = (bx*x + bz*z) * 2.0;
+
+		grad[0] = (y*2.0)*fa0 + (-x*2.0)*fa1 + (-w*2.0)*fa2
+				+ (j00*fm0 + j01*fm1 + j02*fm2);
+		grad[1] = (-z*2.0)*fa0 + (-w*2.0)*fa1 + (x*2.0)*fa2
+				+ (j10*fm0 + j02*fm1 + (-j01)*fm2);
+		grad[2] = (w*2.0)*fa0 + (-z*2.0)*fa1 + (y*2.0)*fa2
+				+ ((-j02)*fm0 + j10*fm1 + j00*fm2);
+		grad[3] = (-x*2.0)*fa0 + (-y*2.0)*fa1 + (-z*2.0)*fa2
+				+ (j01*fm0 + (-j00)*fm1 + j10*fm2);
+	}
+
+	/****************************************************************************
+	 ***************************************************************************/
+	void gradientWilson(const size_t lane, const SimdPack &w, const SimdPack &x,
+			const SimdPack &y, const SimdPack &z, SimdPack grad[4]) const
+	{
+		SimdPack ax = SimdPack::load(&ax_[lane]), ay = SimdPack::load(&ay_[lane]),
+				az = SimdPack::load(&az_[lane]);
+		SimdPack mx = SimdPack::load(&mx_[lane]), my = SimdPack::load(&my_[lane]),
+				mz = SimdPack::load(&mz_[lane]);
+
+		/** difference equations ************************************************/
+		SimdPack fa0 = (w*y - x*z) * 2.0 - ax;
+		SimdPack fa1 = (-w*x - y*z) * 2.0 - ay;
+		SimdPack fa2 = -w*w + x*x + y*y - z*z - az;
+
+		SimdPack fm0 = (-w*z - x*y) * 2.0 - mx;
+		SimdPack fm1 = -w*w + x*x - y*y + z*z - my;
+		SimdPack fm2 = (w*x - y*z) * 2.0 - mz;
+
+		/** Jacobians times difference equations ********************************/
+		grad[0] = (y*2.0)*fa0 + (-x*2.0)*fa1 + (-w*2.0)*fa2
+				+ ((-z*2.0)*fm0 + (-w*2.0)*fm1 + (x*2.0)*fm2);
+		grad[1] = (-z*2.0)*fa0 + (-w*2.0)*fa1 + (x*2.0)*fa2
+				+ ((-y*2.0)*fm0 + (x*2.0)*fm1 + (w*2.0)*fm2);
+		grad[2] = (w*2.0)*fa0 + (-z*2.0)*fa1 + (y*2.0)*fa2
+				+ ((-x*2.0)*fm0 + (-y*2.0)*fm1 + (-z*2.0)*fm2);
+		grad[3] = (-x*2.0)*fa0 + (-y*2.0)*fa1 + (-z*2.0)*fa2
+				+ ((-w*2.0)*fm0 + (z*2.0)*fm1 + (-y*2.0)*fm2);
+	}
+
+	/****************************************************************************
+	 ***************************************************************************/
+	void gradientQGD(const size_t lane, const SimdPack &w, const SimdPack &x,
+			const SimdPack &y, const SimdPack &z, SimdPack grad[4]) const
+	{
+		SimdPack ax = SimdPack::load(&ax_[lane]), ay = SimdPack::load(&ay_[lane]),
+				az = SimdPack::load(&az_[lane]);
+		SimdPack mx = SimdPack::load(&mx_[lane]), my = SimdPack::load(&my_[lane]),
+				mz = SimdPack::load(&mz_[lane]);
+
+		/** quaternion matrices times acc and mag, their first columns are zero */
+		grad[0] = (-y*ax + x*ay + w*az) + (z*mx + w*my + (-x)*mz);
+		grad[1] = (z*ax + w*ay + (-x)*az) + (y*mx + (-x)*my + (-w)*mz);
+		grad[2] = (-w*ax + z*ay + (-y)*az) + (x*mx + y*my + z*mz);
+		grad[3] = (x*ax + y*ay + z*az) + (w*mx + (-z)*my + y*mz);
+	}
+
+	/****************************************************************************
+	 * advance the pack of lanes starting at lane by a sample
+	 ***************************************************************************/
+	void step(const size_t lane, const SimdPack &samplingTime)
+	{
+		SimdPack w = SimdPack::load(&qw_[lane]), x = SimdPack::load(&qx_[lane]),
+				y = SimdPack::load(&qy_[lane]), z = SimdPack::load(&qz_[lane]);
+
+		/** upper branch: calculate and normalize the gradient *******************/
+		SimdPack grad[4];
+		if (algorithm_ == MADGWICK) {
+			gradientMadgwick(lane, w, x, y, z, grad);
+		}
+		else if (algorithm_ == WILSON) {
+			gradientWilson(lane, w, x, y, z, grad);
+		}
+		else {
+			gradientQGD(lane, w, x, y, z, grad);
+		}
+		SimdPack norm = replaceZero(sqrt(grad[0]*grad[0]
+				+ (grad[1]*grad[1] + grad[2]*grad[2] + grad[3]*grad[3])));
+		SimdPack beta = SimdPack::load(&beta_[lane]);
+		for (unsigned k = 0; k < 4; k++) {
+			grad[k] = grad[k] / norm * beta;
+		}
+
+		/** lower branch: q_dot = 0.5 * q * gyro - gradient *********************/
+		SimdPack gw = SimdPack::load(&gw_[lane]), gx = SimdPack::load(&gx_[lane]),
+				gy = SimdPack::load(&gy_[lane]), gz = SimdPack::load(&gz_[lane]);
+		SimdPack dw = (w*gw - (x*gx + y*gy + z*gz)) * 0.5 - grad[0];
+		SimdPack dx = (w*gx + gw*x + (y*gz - z*gy)) * 0.5 - grad[1];
+		SimdPack dy = (w*gy + gw*y + (z*gx - x*gz)) * 0.5 - grad[2];
+		SimdPack dz = (w*gz + gw*z + (x*gy - y*gx)) * 0.5 - grad[3];
+
+		/** integrate and normalize *********************************************/
+		w = w + dw * samplingTime;
+		x = x + dx * samplingTime;
+		y = y + dy * samplingTime;
+		z = z + dz * samplingTime;
+		norm = replaceZero(sqrt(w*w + (x*x + y*y + z*z)));
+		(w / norm).store(&qw_[lane]);
+		(x / norm).store(&qx_[lane]);
+		(y / norm).store(&qy_[lane]);
+		(z / norm).store(&qz_[lane]);
+	}
+
+public:
+	/****************************************************************************
+	 * a lane per beta value, magRef is the reference of the magnetic field of
+	 * the Madgwick algorithm
+	 ***************************************************************************/
+	BatchFusionBlock(const Algorithm algorithm = QGD,
+			const std::vector<double> &betas = {},
+			const Quaternion &magRef = {0,1,0,0})
+	: algorithm_(algorithm), numLanes_(betas.size())
+	{
+		size_t size = getNumPaddedLanes();
+		for (std::vector<double> *lanes : {&qw_, &qx_, &qy_, &qz_, &beta_,
+				&magRefX_, &magRefZ_, &gw_, &gx_, &gy_, &gz_, &ax_, &ay_, &az_,
+				&mx_, &my_, &mz_}) {
+			lanes->assign(size, 0.0);
+		}
+		qw_.assign(size, 1.0);
+		std::copy(betas.begin(), betas.end(), beta_.begin());
+		magRefX_.assign(size, magRef.v1());
+		magRefZ_.assign(size, magRef.v3());
+	}
+
+	/****************************************************************************
+	 ***************************************************************************/
+	Algorithm getAlgorithm() const
+	{
+		return algorithm_;
+	}
+
+	/****************************************************************************
+	 ***************************************************************************/
+	size_t getNumLanes() const
+	{
+		return numLanes_;
+	}
+
+	/****************************************************************************
+	 * the number of lanes rounded up to whole lane groups
+	 ***************************************************************************/
+	size_t getNumPaddedLanes() const
+	{
+		return (numLanes_ + LANE_GROUP - 1) / LANE_GROUP * LANE_GROUP;
+	}
+
+	/****************************************************************************
+	 ***************************************************************************/
+	void setBeta(const size_t lane, const double beta)
+	{
+		beta_[lane] = beta;
+	}
+
+	/****************************************************************************
+	 ***************************************************************************/
+	double getBeta(const size_t lane) const
+	{
+		return beta_[lane];
+	}
+
+	/****************************************************************************
+	 ***************************************************************************/
+	void setMagRef(const size_t lane, const Quaternion &magRef)
+	{
+		magRefX_[lane] = magRef.v1();
+		magRefZ_[lane] = magRef.v3();
+	}
+
+	/****************************************************************************
+	 * the orientation of a lane, i.e. the previous estimate
+	 ***************************************************************************/
+	void setQuaternion(const size_t lane, const Quaternion &q)
+	{
+		qw_[lane] = q.s();
+		qx_[lane] = q.v1();
+		qy_[lane] = q.v2();
+		qz_[lane] = q.v3();
+	}
+
+	/****************************************************************************
+	 ***************************************************************************/
+	Quaternion getQuaternion(const size_t lane) const
+	{
+		return Quaternion(qw_[lane], qx_[lane], qy_[lane], qz_[lane]);
+	}
+
+	/****************************************************************************
+	 * the orientation of a lane as s, v1, v2, v3
+	 ***************************************************************************/
+	void getQuaternion(const size_t lane, double *q) const
+	{
+		q[0] = qw_[lane];
+		q[1] = qx_[lane];
+		q[2] = qy_[lane];
+		q[3] = qz_[lane];
+	}
+
+	/****************************************************************************
+	 * set the sample of the lanes from firstLane up to lastLane (excluded)
+	 ***************************************************************************/
+	void setSample(const Quaternion &gyro, const Quaternion &acc,
+			const Quaternion &mag, const size_t firstLane, const size_t lastLane)
+	{
+		double as = acc.s(), ax = acc.v1(), ay = acc.v2(), az = acc.v3();
+		double ms = mag.s(), mx = mag.v1(), my = mag.v2(), mz = mag.v3();
+		normalize(as, ax, ay, az);
+		normalize(ms, mx, my, mz);
+		for (size_t lane = firstLane; lane < lastLane; lane++) {
+			gw_[lane] = gyro.s();
+			gx_[lane] = gyro.v1();
+			gy_[lane] = gyro.v2();
+			gz_[lane] = gyro.v3();
+			ax_[lane] = ax;
+			ay_[lane] = ay;
+			az_[lane] = az;
+			mx_[lane] = mx;
+			my_[lane] = my;
+			mz_[lane] = mz;
+		}
+	}
+
+	/****************************************************************************
+	 * set the sample of a single lane
+	 ***************************************************************************/
+	void setSample(const size_t lane, const Quaternion &gyro,
+			const Quaternion &acc, const Quaternion &mag)
+	{
+		setSample(gyro, acc, mag, lane, lane + 1);
+	}
+
+	/****************************************************************************
+	 * run the fusion algorithm with the samples set of the lane groups from
+	 * firstLane up to lastLane (excluded), firstLane has to be the first lane
+	 * of a group. The lanes of different groups may be run concurrently.
+	 ***************************************************************************/
+	void run(const double samplingTime, const size_t firstLane = 0,
+			size_t lastLane = (size_t) -1)
+	{
+		lastLane = std::min(lastLane, getNumPaddedLanes());
+		SimdPack dt(samplingTime);
+		for (size_t lane = firstLane; lane < lastLane; lane += SimdPack::WIDTH) {
+			step(lane, dt);
+		}
+	}
+};
+
+/**############################################################################
+# END OF FILE
+#############################################################################*/
+
+#endif /* __BATCHFUSIONBLOCK_H ************************************************/
@@ -0,0 +1,146 @@
+/**############################################################################
+#
+# Description: Check of the batched fusion algorithms against the scalar ones
+#
+#
+# Copyright (C) 2024 by Hristina Radak
+#
+# Email: hristinaradak95@gmail.com
+#
+###############################################################################
+# BatchFusionBlock repeats the math of Madgwick1FusionBlock, WilsonFusionBlock
+# and QuaternionGradientDescentBlock. The check runs the same random samples
+# through a batch of lanes and through a scalar block per lane and reports
+# the largest difference of the orientations of any lane, so a change to one
+# of the algorithms that is not made to the other shows up.
+#############################################################################*/
+
+#ifndef __BATCHFUSIONCHECK_H
+#define __BATCHFUSIONCHECK_H
+
+/**############################################################################
+# INCLUDES
+#############################################################################*/
+
+#include <cmath>
+#include <vector>
+
+#include "../tools/common/philox.hpp"
+#include "../tools/quaternion/quaternion.hpp"
+#include "./batchfusionblock.hpp"
+#include "./madgwick-original.hpp"
+#include "./qgdfusionblock.hpp"
+#include "./wilsonfusionblock.hpp"
+
+/**############################################################################
+# CLASS DECLARATIONS
+#############################################################################*/
+
+/******************************************************************************
+ *****************************************************************************/
+class BatchFusionCheck {
+
+	/** the sampling time of the checked samples *******************************/
+	static constexpr double SAMPLING_TIME = 0.01;
+
+	const Philox stream_;
+	Quaternion magRef_;
+
+	/****************************************************************************
+	 * a uniform random number in [-1, 1) of word k of block i of channel c
+	 ***************************************************************************/
+	double getRandom(const unsigned i, const unsigned c, const unsigned k) const
+	{
+		return 2.0 * Philox::toUniform(stream_({i, c, 0, 0})[k]) - 1.0;
+	}
+
+	/****************************************************************************
+	 * the pure quaternion (0, x, y, z) of channel c of sample i, spread around
+	 * (x, y, z) by up to spread
+	 ***************************************************************************/
+	Quaternion getVector(const unsigned i, const unsigned c, const double x,
+			const double y, const double z, const double spread) const
+	{
+		return Quaternion(0, x + spread * getRandom(i, c, 0),
+				y + spread * getRandom(i, c, 1), z + spread * getRandom(i, c, 2));
+	}
+
+	/****************************************************************************
+	 ***************************************************************************/
+	Quaternion getStart(const size_t lane) const
+	{
+		Quaternion q(1 + getRandom(lane, 3, 0), getRandom(lane, 3, 1),
+				getRandom(lane, 3, 2), getRandom(lane, 3, 3));
+		q.to_normalized();
+		return q;
+	}
+
+public:
+	/****************************************************************************
+	 * magRef is the reference of the magnetic field of the Madgwick algorithm
+	 ***************************************************************************/
+	BatchFusionCheck(const Quaternion &magRef = {0,1,0,0})
+	: stream_("BatchFusionCheck"), magRef_(magRef)
+	{
+	}
+
+	/****************************************************************************
+	 * the largest difference of any component of the orientations of any lane
+	 * after numSamples samples, a lane per beta value
+	 ***************************************************************************/
+	double run(const BatchFusionBlock::Algorithm algorithm,
+			const std::vector<double> &betas, const unsigned numSamples) const
+	{
+		BatchFusionBlock batch(algorithm, betas, magRef_);
+		std::vector<Quaternion> scalar(betas.size());
+		std::vector<Madgwick1FusionBlock> madgwick;
+		std::vector<WilsonFusionBlock> wilson;
+		std::vector<QuaternionGradientDescentBlock> qgd;
+		for (size_t lane = 0; lane < betas.size(); lane++) {
+			scalar[lane] = getStart(lane);
+			batch.setQuaternion(lane, scalar[lane]);
+			madgwick.emplace_back(betas[lane], magRef_);
+			wilson.emplace_back(betas[lane]);
+			qgd.emplace_back(betas[lane]);
+		}
+
+		for (unsigned i = 0; i < numSamples; i++) {
+			Quaternion gyro = getVector(i, 0, 0, 0, 0, 1.0);
+			Quaternion acc = getVector(i, 1, 0, 0, 1, 0.2);
+			Quaternion mag = getVector(i, 2, 0.4, 0, 0.9, 0.1);
+			batch.setSample(gyro, acc, mag, 0, batch.getNumPaddedLanes());
+			batch.run(SAMPLING_TIME);
+			for (size_t lane = 0; lane < betas.size(); lane++) {
+				if (algorithm == BatchFusionBlock::MADGWICK) {
+					scalar[lane] = madgwick[lane].run(gyro, acc, mag, SAMPLING_TIME,
+							scalar[lane]);
+				}
+				else if (algorithm == BatchFusionBlock::WILSON) {
+					scalar[lane] = wilson[lane].run(gyro, acc, mag, SAMPLING_TIME,
+							scalar[lane]);
+				}
+				else {
+					scalar[lane] = qgd[lane].run(gyro, acc, mag, SAMPLING_TIME,
+							scalar[lane]);
+				}
+			}
+		}
+
+		double difference = 0;
+		for (size_t lane = 0; lane < betas.size(); lane++) {
+			double q[4];
+			batch.getQuaternion(lane, q);
+			difference = std::max({difference, std::fabs(q[0] - scalar[lane].s()),
+					std::fabs(q[1] - scalar[lane].v1()),
+					std::fabs(q[2] - scalar[lane].v2()),
+					std::fabs(q[3] - scalar[lane].v3())});
+		}
+		return difference;
+	}
+};
+
+/**############################################################################
+# END OF FILE
+#############################################################################*/
+
+#endif /* __BATCHFUSIONCHECK_H ************************************************/
@@ -0,0 +1,163 @@
+/**############################################################################
+#
+# Description: A pack of doubles processed by a single SIMD instruction
+#
+#
+# Copyright (C) 2024 by Hristina Radak
+#
+# Email: hristinaradak95@gmail.com
+#
+###############################################################################
+# The widest vector registers the compiler is allowed to use are taken: 8
+# doubles with AVX-512 (-mavx512f), 4 with AVX or AVX2 (-mavx, -mavx2), a
+# single one otherwise. The project builds with -mavx2, -march=native picks
+# the ones of the host instead. The operations are rounded as IEEE 754
+# demands, thus any kernel written with packs gives the same results for any
+# width, unless the compiler contracts them to fused multiply-adds (-mfma,
+# implied by -mavx512f), which the build prevents by -ffp-contract=off.
+#############################################################################*/
+
+#ifndef __SIMDPACK_H
+#define __SIMDPACK_H
+
+/**############################################################################
+# INCLUDES
+#############################################################################*/
+
+#include <cmath>
+
+#if defined(__AVX512F__) || defined(__AVX__)
+#include <immintrin.h>
+#endif
+
+/**############################################################################
+# CLASS DECLARATIONS
+#############################################################################*/
+
+#if defined(__AVX512F__)
+
+/******************************************************************************
+ *****************************************************************************/
+class SimdPack {
+
+	__m512d v_;
+
+public:
+	/** the number of doubles of a pack ****************************************/
+	static const unsigned WIDTH = 8;
+
+	SimdPack() : v_(_mm512_setzero_pd()) {}
+	SimdPack(const __m512d v) : v_(v) {}
+	SimdPack(const double value) : v_(_mm512_set1_pd(value)) {}
+
+	/****************************************************************************
+	 * load and store WIDTH doubles, not necessarily aligned
+	 ***************************************************************************/
+	static SimdPack load(const double *p) { return _mm512_loadu_pd(p); }
+	void store(double *p) const { _mm512_storeu_pd(p, v_); }
+
+	friend SimdPack operator+(const SimdPack &a, const SimdPack &b) { return _mm512_add_pd(a.v_, b.v_); }
+	friend SimdPack operator-(const SimdPack &a, const SimdPack &b) { return _mm512_sub_pd(a.v_, b.v_); }
+	friend SimdPack operator*(const SimdPack &a, const SimdPack &b) { return _mm512_mul_pd(a.v_, b.v_); }
+	friend SimdPack operator/(const SimdPack &a, const SimdPack &b) { return _mm512_div_pd(a.v_, b.v_); }
+	friend SimdPack operator-(const SimdPack &a) { return _mm512_castsi512_pd(_mm512_xor_si512(
+			_mm512_castpd_si512(a.v_), _mm512_set1_epi64(0x8000000000000000LL))); }
+
+	/****************************************************************************
+	 * zero-masked, as the unmasked intrinsic of GCC reads an undefined register
+	 ***************************************************************************/
+	friend SimdPack sqrt(const SimdPack &a) { return _mm512_maskz_sqrt_pd(0xFF, a.v_); }
+
+	/****************************************************************************
+	 * 1 where a is zero, a elsewhere
+	 ***************************************************************************/
+	friend SimdPack replaceZero(const SimdPack &a)
+	{
+		__mmask8 zero = _mm512_cmp_pd_mask(a.v_, _mm512_setzero_pd(), _CMP_EQ_OQ);
+		return _mm512_mask_blend_pd(zero, a.v_, _mm512_set1_pd(1.0));
+	}
+};
+
+#elif defined(__AVX__)
+
+/******************************************************************************
+ *****************************************************************************/
+class SimdPack {
+
+	__m256d v_;
+
+public:
+	/** the number of doubles of a pack ****************************************/
+	static const unsigned WIDTH = 4;
+
+	SimdPack() : v_(_mm256_setzero_pd()) {}
+	SimdPack(const __m256d v) : v_(v) {}
+	SimdPack(const double value) : v_(_mm256_set1_pd(value)) {}
+
+	/****************************************************************************
+	 * load and store WIDTH doubles, not necessarily aligned
+	 ***************************************************************************/
+	static SimdPack load(const double *p) { return _mm256_loadu_pd(p); }
+	void store(double *p) const { _mm256_storeu_pd(p, v_); }
+
+	friend SimdPack operator+(const SimdPack &a, const SimdPack &b) { return _mm256_add_pd(a.v_, b.v_); }
+	friend SimdPack operator-(const SimdPack &a, const SimdPack &b) { return _mm256_sub_pd(a.v_, b.v_); }
+	friend SimdPack operator*(const SimdPack &a, const SimdPack &b) { return _mm256_mul_pd(a.v_, b.v_); }
+	friend SimdPack operator/(const SimdPack &a, const SimdPack &b) { return _mm256_div_pd(a.v_, b.v_); }
+	friend SimdPack operator-(const SimdPack &a) { return _mm256_xor_pd(a.v_, _mm256_set1_pd(-0.0)); }
+	friend SimdPack sqrt(const SimdPack &a) { return _mm256_sqrt_pd(a.v_); }
+
+	/****************************************************************************
+	 * 1 where a is zero, a elsewhere
+	 ***************************************************************************/
+	friend SimdPack replaceZero(const SimdPack &a)
+	{
+		__m256d zero = _mm256_cmp_pd(a.v_, _mm256_setzero_pd(), _CMP_EQ_OQ);
+		return _mm256_blendv_pd(a.v_, _mm256_set1_pd(1.0), zero);
+	}
+};
+
+#else
+
+/******************************************************************************
+ *****************************************************************************/
+class SimdPack {
+
+	double v_;
+
+public:
+	/** the number of doubles of a pack ****************************************/
+	static const unsigned WIDTH = 1;
+
+	SimdPack() : v_(0.0) {}
+	SimdPack(const double value) : v_(value) {}
+
+	/****************************************************************************
+	 * load and store WIDTH doubles
+	 ***************************************************************************/
+	static SimdPack load(const double *p) { return *p; }
+	void store(double *p) const { *p = v_; }
+
+	friend SimdPack operator+(const SimdPack &a, const SimdPack &b) { return a.v_ + b.v_; }
+	friend SimdPack operator-(const SimdPack &a, const SimdPack &b) { return a.v_ - b.v_; }
+	friend SimdPack operator*(const SimdPack &a, const SimdPack &b) { return a.v_ * b.v_; }
+	friend SimdPack operator/(const SimdPack &a, const SimdPack &b) { return a.v_ / b.v_; }
+	friend SimdPack operator-(const SimdPack &a) { return -a.v_; }
+	friend SimdPack sqrt(const SimdPack &a) { return std::sqrt(a.v_); }
+
+	/****************************************************************************
+	 * 1 where a is zero, a elsewhere
+	 ***************************************************************************/
+	friend SimdPack replaceZero(const SimdPack &a)
+	{
+		return (a.v_ == 0) ? 1.0 : a.v_;
+	}
+};
+
+#endif
+
+/**############################################################################
+# END OF FILE
+#############################################################################*/
+
+#endif /* __SIMDPACK_H ********************************************************/
@@ -0,0 +1,273 @@
+/**############################################################################
+#
+#
+# Copyright (C) 2021 by Christian Scheunert
+#
+# Email: christian.scheunert@tu-dresden.de
+#
+#############################################################################*/
+
+/**############################################################################
+# INCLUDES
+#############################################################################*/
+
+#include "gorilla.h"
+
+#include <cstring>
+
+
+/**############################################################################
+# DEFINES
+#############################################################################*/
+
+
+/**############################################################################
+# LOCAL DEFINITIONS
+#############################################################################*/
+
+/******************************************************************************
+ * The window marking that no previous XOR has been stored yet.
+ *****************************************************************************/
+static const unsigned long NO_WINDOW = 64;
+
+
+/******************************************************************************
+ * The maximum number of leading zeros that can be stored.
+ *****************************************************************************/
+static const unsigned long MAX_LEADING = 31;
+
+
+/**############################################################################
+# MEMBER DEFINITIONS
+#############################################################################*/
+
+/******************************************************************************
+ *****************************************************************************/
+GorillaEncoder::GorillaEncoder()
+{
+  bits = 0;
+  numBits = 0;
+  numValues = 0;
+  previous = 0;
+  leading = NO_WINDOW;
+  trailing = NO_WINDOW;
+}
+
+
+/******************************************************************************
+ *****************************************************************************/
+void GorillaEncoder::putBits(const uint64_t &_value,
+                             const unsigned long &_numBits)
+{
+  uint64_t value;
+  unsigned long free;
+  unsigned long i;
+
+  if (_numBits == 0) {
+    return;
+  }
+  value = (_numBits < 64) ? (_value & ((uint64_t(1) << _numBits) - 1))
+                          : _value;
+  free = 64 - numBits;
+
+  /** the bits fit into the current word ************************************/
+  if (_numBits < free) {
+    bits |= value << (free - _numBits);
+    numBits += _numBits;
+    return;
+  }
+
+  /** otherwise fill the word, store it and keep the remaining bits *********/
+  bits |= value >> (_numBits - free);
+  for (i = 0; i < 8; i++) {
+    stream.push_back(static_cast<char>(bits >> (56 - 8 * i)));
+  }
+  numBits = _numBits - free;
+  bits = (numBits > 0) ? (value << (64 - numBits)) : 0;
+}
+
+
+/******************************************************************************
+ *****************************************************************************/
+void GorillaEncoder::put(const double &_value)
+{
+  uint64_t value;
+  uint64_t x;
+  unsigned long lz;
+  unsigned long tz;
+
+  memcpy(&value, &_value, sizeof(value));
+
+  /** the first value is stored as is ***************************************/
+  if (numValues++ == 0) {
+    putBits(value, 64);
+    previous = value;
+    return;
+  }
+
+  /** a value equal to its predecessor takes a single bit *******************/
+  x = value ^ previous;
+  previous = value;
+  if (x == 0) {
+    putBits(0, 1);
+    return;
+  }
+
+  /** reuse the previous window if the meaningful bits fit into it **********/
+  lz = __builtin_clzll(x);
+  tz = __builtin_ctzll(x);
+  if (lz > MAX_LEADING) {
+    lz = MAX_LEADING;
+  }
+  if ((leading != NO_WINDOW) && (lz >= leading) && (tz >= trailing)) {
+    putBits(2, 2);
+    putBits(x >> trailing, 64 - leading - trailing);
+    return;
+  }
+
+  /** otherwise store a new window ******************************************/
+  leading = lz;
+  trailing = tz;
+  putBits(3, 2);
+  putBits(leading, 5);
+  putBits((64 - leading - trailing) & 63, 6);
+  putBits(x >> trailing, 64 - leading - trailing);
+}
+
+
+/******************************************************************************
+ *****************************************************************************/
+vector<char> GorillaEncoder::finish()
+{
+  vector<char> result;
+  unsigned long i;
+
+  for (i = 0; i < (numBits + 7) / 8; i++) {
+    stream.push_back(static_cast<char>(bits >> (56 - 8 * i)));
+  }
+  stream.insert(stream.end(), GORILLA_PADDING_SIZE, 0);
+  result.swap(stream);
+  *this = GorillaEncoder();
+  return(result);
+}
+
+
+/******************************************************************************
+ *****************************************************************************/
+GorillaDecoder::GorillaDecoder()
+{
+  p_stream = NULL;
+  streamBits = 0;
+  rewind();
+}
+
+
+/******************************************************************************
+ *****************************************************************************/
+void GorillaDecoder::setStream(const char *_stream, const size_t &_size)
+{
+  p_stream = _stream;
+  streamBits = (_size > GORILLA_PADDING_SIZE)
+               ? (_size - GORILLA_PADDING_SIZE) * 8 : 0;
+  rewind();
+}
+
+
+/******************************************************************************
+ *****************************************************************************/
+void GorillaDecoder::rewind()
+{
+  position = 0;
+  numValues = 0;
+  previous = 0;
+  leading = 0;
+  meaningful = 0;
+}
+
+
+/******************************************************************************
+ *****************************************************************************/
+uint64_t GorillaDecoder::getBits(const unsigned long &_numBits)
+{
+  const unsigned char *p_byte;
+  uint64_t word;
+  unsigned long i;
+
+  if (_numBits == 0) {
+    return(0);
+  }
+  p_byte = reinterpret_cast<const unsigned char *>(p_stream) + (position >> 3);
+  word = 0;
+  for (i = 0; i < 8; i++) {
+    word = (word << 8) | p_byte[i];
+  }
+  word <<= (position & 7);
+  position += _numBits;
+  return(word >> (64 - _numBits));
+}
+
+
+/******************************************************************************
+ *****************************************************************************/
+uint64_t GorillaDecoder::getLongBits(const unsigned long &_numBits)
+{
+  uint64_t high;
+
+  if (_numBits <= 32) {
+    return(getBits(_numBits));
+  }
+  high = getBits(_numBits - 32);
+  return((high << 32) | getBits(32));
+}
+
+
+/******************************************************************************
+ *****************************************************************************/
+bool GorillaDecoder::get(double *_values, const unsigned long &_size,
+                         const unsigned long &_stride)
+{
+  unsigned long i;
+
+  for (i = 0; i < _size; i++) {
+    /** a whole value is left within the stream and its padding *************/
+    if (position >= streamBits) {
+      return(false);
+    }
+
+    if (numValues == 0) {
+      previous = getLongBits(64);
+    }
+    else if (getBits(1) == 1) {
+      if (getBits(1) == 1) {
+        leading = getBits(5);
+        meaningful = getBits(6);
+        if (meaningful == 0) {
+          meaningful = 64;
+        }
+        if (leading + meaningful > 64) {
+          return(false);
+        }
+      }
+      if (meaningful == 0) {
+        return(false);
+      }
+      previous ^= getLongBits(meaningful) << (64 - leading - meaningful);
+    }
+    numValues++;
+
+    if (_values != NULL) {
+      memcpy(&_values[i * _stride], &previous, sizeof(previous));
+    }
+  }
+  return(true);
+}
+
+
+/**############################################################################
+# NON MEMBER DEFINITIONS
+#############################################################################*/
+
+
+/**############################################################################
+# END OF FILE
+#############################################################################*/
@@ -0,0 +1,198 @@
+/**############################################################################
+#
+#
+# Copyright (C) 2021 by Christian Scheunert
+#
+# Email: christian.scheunert@tu-dresden.de
+#
+#############################################################################*/
+
+#ifndef __GORILLA_H
+#define __GORILLA_H
+
+
+/**############################################################################
+# INCLUDES
+#############################################################################*/
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+/**############################################################################
+# NAMES
+#############################################################################*/
+
+using namespace std;
+
+
+/**############################################################################
+# DEFINES
+#############################################################################*/
+
+/******************************************************************************
+ * The number of zero bytes appended to any encoded stream, thus the decoder
+ * can read a whole value bit by bit without checking the end of the stream.
+ * @see
+ *****************************************************************************/
+const unsigned long GORILLA_PADDING_SIZE = 16;
+
+
+/**############################################################################
+# CLASS DECLARATIONS
+#############################################################################*/
+
+/******************************************************************************
+ * The purpose of this class is to compress a series of doubles losslessly
+ * the way Facebook's Gorilla time series database does. Any value is XOR-ed
+ * with its predecessor, bit by bit, and only the meaningful bits of the
+ * result are stored:
+ *
+ * @li ------------------------------------------------------------------------
+ * @li bits      content
+ * @li 64        the first value as is
+ * @li '0'       the value equals its predecessor
+ * @li '10' + n  the n meaningful bits fit into the window of the previous
+ * @li           value, i.e. have at least as many leading and trailing zeros
+ * @li '11' + 5 + 6 + n  the number of leading zeros (at most 31), the number
+ * @li           of meaningful bits n (64 stored as 0) and the n bits
+ * @li ------------------------------------------------------------------------
+ *
+ * Bits are stored most significant first. Slowly changing sensor readings
+ * and runs of equal values, e.g. a constant truth quaternion, shrink to a
+ * fraction of their size, while any value including NaN is restored bit by
+ * bit.
+ * @see
+ *****************************************************************************/
+class GorillaEncoder {
+  /** the encoded stream *****************************************************/
+  vector<char> stream;
+  /** the bits not yet stored in the stream, left aligned ********************/
+  uint64_t bits;
+  /** the number of bits in bits *********************************************/
+  unsigned long numBits;
+  /** the number of values encoded so far ************************************/
+  unsigned long numValues;
+  /** the previous value as bits *********************************************/
+  uint64_t previous;
+  /** the window of the meaningful bits of the previous XOR ******************/
+  unsigned long leading;
+  unsigned long trailing;
+  /****************************************************************************
+   * Appends the _numBits lowest bits of _value to the stream.
+   * @see
+   ***************************************************************************/
+  void putBits(const uint64_t &_value, const unsigned long &_numBits);
+public:
+  /****************************************************************************
+   * @see
+   ***************************************************************************/
+  GorillaEncoder();
+  /****************************************************************************
+   * Encodes the next value.
+   * @see
+   ***************************************************************************/
+  void put(const double &_value);
+  /****************************************************************************
+   * Flushes the remaining bits and appends @ref GORILLA_PADDING_SIZE zero
+   * bytes. The encoder starts a new stream afterwards.
+   * @return The encoded stream.
+   * @see
+   ***************************************************************************/
+  vector<char> finish();
+};
+
+
+/******************************************************************************
+ * The purpose of this class is to decompress a stream written by
+ * @ref GorillaEncoder. The values are decoded one after another directly
+ * into the memory given by the caller, thus the decoder keeps its position
+ * and continues with the value following the ones decoded last.
+ * @see
+ *****************************************************************************/
+class GorillaDecoder {
+  /** the encoded stream including the padding *******************************/
+  const char *p_stream;
+  /** the size of the stream in bits, excluding the padding ******************/
+  uint64_t streamBits;
+  /** the position of the next bit to be read ********************************/
+  uint64_t position;
+  /** the number of values decoded so far ************************************/
+  unsigned long numValues;
+  /** the previous value as bits *********************************************/
+  uint64_t previous;
+  /** the window of the meaningful bits of the previous XOR ******************/
+  unsigned long leading;
+  unsigned long meaningful;
+  /****************************************************************************
+   * Reads the next _numBits bits, at most 57 at once.
+   * @see
+   ***************************************************************************/
+  uint64_t getBits(const unsigned long &_numBits);
+  /****************************************************************************
+   * Reads the next _numBits bits, up to 64 at once.
+   * @see
+   ***************************************************************************/
+  uint64_t getLongBits(const unsigned long &_numBits);
+public:
+  /****************************************************************************
+   * @see
+   ***************************************************************************/
+  GorillaDecoder();
+  /****************************************************************************
+   * Sets the stream to decode and moves back to its first value. The stream
+   * is not copied, thus it has to outlive the decoding.
+   * @param _stream The stream as returned by @ref GorillaEncoder::finish().
+   * @param _size   The size of the stream in bytes, including the padding.
+   * @see
+   ***************************************************************************/
+  void setStream(const char *_stream, const size_t &_size);
+  /****************************************************************************
+   * Moves back to the first value of the stream.
+   * @see
+   ***************************************************************************/
+  void rewind();
+  /****************************************************************************
+   * @return The number of values decoded since the last rewind.
+   * @see
+   ***************************************************************************/
+  unsigned long getNumValues() const;
+  /****************************************************************************
+   * Decodes the next _size values into the memory _values points to, stored
+   * _stride elements apart. _values may be NULL to skip values.
+   * @return False if the stream ends before, otherwise true.
+   * @see
+   ***************************************************************************/
+  bool get(double *_values, const unsigned long &_size,
+           const unsigned long &_stride = 1);
+};
+
+
+/**############################################################################
+# INLINE MEMBER DEFINITIONS
+#############################################################################*/
+
+/******************************************************************************
+ *****************************************************************************/
+inline unsigned long GorillaDecoder::getNumValues() const
+{
+  return(numValues);
+}
+
+
+/**############################################################################
+# TEMPLATE MEMBER DEFINITIONS
+#############################################################################*/
+
+
+/**############################################################################
+# NON MEMBER DECLARATIONS
+#############################################################################*/
+
+
+/**############################################################################
+# END OF FILE
+#############################################################################*/
+
+#endif /* __GORILLA_H ********************************************************/
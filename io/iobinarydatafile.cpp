@@ -0,0 +1,631 @@
+/**############################################################################
+#
+#
+# Copyright (C) 2021 by Christian Scheunert
+#
+# Email: christian.scheunert@tu-dresden.de
+#
+#############################################################################*/
+
+/**############################################################################
+# INCLUDES
+#############################################################################*/
+
+#include "iobinarydatafile.h"
+
+#include <algorithm>
+#include <cstring>
+
+
+/**############################################################################
+# DEFINES
+#############################################################################*/
+
+
+/**############################################################################
+# LOCAL DEFINITIONS
+#############################################################################*/
+
+/******************************************************************************
+ * @return True if the host stores numbers little-endian.
+ *****************************************************************************/
+static bool isLittleEndian()
+{
+  const uint16_t one = 1;
+  return(*reinterpret_cast<const unsigned char *>(&one) == 1);
+}
+
+
+/******************************************************************************
+ * Reverses the byte order of _size bytes _p points to.
+ *****************************************************************************/
+static void swapBytes(void *_p, const unsigned long &_size)
+{
+  unsigned char *p_byte = static_cast<unsigned char *>(_p);
+  reverse(p_byte, p_byte + _size);
+}
+
+
+/******************************************************************************
+ * Copies a little-endian number from the memory _p points to into _value.
+ *****************************************************************************/
+template<typename T> static void getNumber(T &_value, const char *_p)
+{
+  memcpy(&_value, _p, sizeof(T));
+  if (! isLittleEndian()) {
+    swapBytes(&_value, sizeof(T));
+  }
+}
+
+
+/******************************************************************************
+ * Copies the number _value little-endian into the memory _p points to.
+ *****************************************************************************/
+template<typename T> static void setNumber(char *_p, T _value)
+{
+  if (! isLittleEndian()) {
+    swapBytes(&_value, sizeof(T));
+  }
+  memcpy(_p, &_value, sizeof(T));
+}
+
+
+/**############################################################################
+# MEMBER DEFINITIONS
+#############################################################################*/
+
+/******************************************************************************
+ *****************************************************************************/
+IoBinaryDataFileExcept::IoBinaryDataFileExcept(int _num)
+: IoDataFileExcept(_num)
+{
+
+}
+
+
+/******************************************************************************
+ *****************************************************************************/
+IoBinaryDataFile::IoBinaryDataFile(const string &_fileName)
+{
+  try {
+    fileName = _fileName;
+    haveHeader = false;
+    numSamples = 0;
+    dataType = 0;
+  }
+  catch (...) {
+    cerr << "ERROR : UNKNOWN : ";
+    cerr << "IoBinaryDataFile::IoBinaryDataFile" << endl;
+    throw;
+  }
+}
+
+
+/******************************************************************************
+ *****************************************************************************/
+IoBinaryDataFile::~IoBinaryDataFile()
+{
+  try {
+    if (file.is_open()) {
+      file.close();
+    }
+  }
+  catch (...) {
+    cerr << "ERROR : UNKNOWN : ";
+    cerr << "IoBinaryDataFile::~IoBinaryDataFile" << endl;
+    throw;
+  }
+}
+
+
+/******************************************************************************
+ *****************************************************************************/
+void IoBinaryDataFile::readHeader()
+{
+  vector<char> header;
+  uint32_t version;
+  uint32_t numChannels;
+  uint32_t channelSize;
+  uint64_t samples;
+  unsigned long i;
+  const char *p_entry;
+
+  try {
+    if (haveHeader) {
+      return;
+    }
+    if (fileName == "") {
+      throw IoFileExcept(ERROR_MISSING_FILE_NAME);
+    }
+
+    /** open the file ********************************************************/
+    if (file.is_open()) {
+      file.close();
+    }
+    file.clear();
+    file.open(fileName.c_str(), ios::in | ios::binary);
+    if (! file.is_open()) {
+      throw IoFileExcept(ERROR_COULD_NOT_OPEN_FILE);
+    }
+
+    /** read the fixed part of the header ************************************/
+    header.resize(BINARY_DATA_HEADER_SIZE);
+    if (! file.read(header.data(), header.size())) {
+      throw IoBinaryDataFileExcept(ERROR_WRONG_FILE_FORMAT);
+    }
+    if (BINARY_DATA_FILE_MAGIC.compare(0, BINARY_DATA_FILE_MAGIC.size(),
+                                       header.data(),
+                                       BINARY_DATA_FILE_MAGIC.size()) != 0) {
+      throw IoBinaryDataFileExcept(ERROR_WRONG_FILE_FORMAT);
+    }
+    getNumber(version, &header[8]);
+    getNumber(dataType, &header[12]);
+    getNumber(samples, &header[16]);
+    getNumber(numChannels, &header[24]);
+    getNumber(channelSize, &header[28]);
+    if ((version != BINARY_DATA_FILE_VERSION)
+        || (channelSize != BINARY_DATA_CHANNEL_SIZE)) {
+      throw IoBinaryDataFileExcept(ERROR_WRONG_FILE_FORMAT);
+    }
+    if ((dataType != BINARY_DATA_TYPE_FLOAT64)
+        && (dataType != BINARY_DATA_TYPE_GORILLA)) {
+      throw IoBinaryDataFileExcept(ERROR_UNSUPPORTED_DATA_TYPE);
+    }
+    numSamples = samples;
+
+    /** read the channel list ************************************************/
+    header.resize(static_cast<unsigned long>(numChannels) * channelSize);
+    if (! file.read(header.data(), header.size())) {
+      throw IoBinaryDataFileExcept(ERROR_WRONG_FILE_FORMAT);
+    }
+    channelList.clear();
+    channelList.resize(numChannels);
+    for (i = 0; i < numChannels; i++) {
+      p_entry = &header[i * channelSize];
+      string name(p_entry, strnlen(p_entry, BINARY_DATA_CHANNEL_NAME_SIZE));
+      if (name.find(CHANNEL_SEPARATOR) == string::npos) {
+        throw IoBinaryDataFileExcept(ERROR_WRONG_FILE_FORMAT);
+      }
+      channelList[i].section = name.substr(0, name.find(CHANNEL_SEPARATOR));
+      channelList[i].key = name.substr(name.find(CHANNEL_SEPARATOR)
+                                       + CHANNEL_SEPARATOR.size());
+      getNumber(channelList[i].offset,
+                p_entry + BINARY_DATA_CHANNEL_NAME_SIZE);
+      getNumber(channelList[i].size,
+                p_entry + BINARY_DATA_CHANNEL_NAME_SIZE + sizeof(uint64_t));
+    }
+    haveHeader = true;
+  }
+  catch (IoFileExcept &_e) {
+    if (_e.num == ERROR_WRONG_FILE_FORMAT) {
+      cerr << "ERROR : WRONG_FILE_FORMAT : ";
+    }
+    if (_e.num == ERROR_UNSUPPORTED_DATA_TYPE) {
+      cerr << "ERROR : UNSUPPORTED_DATA_TYPE : ";
+      cerr << "type = " << dataType << " : ";
+    }
+    if (_e.num == ERROR_COULD_NOT_OPEN_FILE) {
+      cerr << "ERROR : COULD_NOT_OPEN_FILE : ";
+    }
+    if (_e.num == ERROR_MISSING_FILE_NAME) {
+      cerr << "ERROR : MISSING_FILE_NAME : ";
+    }
+    cerr << "file = " << '"' << fileName << '"' << " : ";
+    cerr << "IoBinaryDataFile::readHeader" << endl;
+    channelList.clear();
+    file.close();
+    throw;
+  }
+  catch (...) {
+    cerr << "ERROR : UNKNOWN : ";
+    cerr << "IoBinaryDataFile::readHeader" << endl;
+    channelList.clear();
+    file.close();
+    throw;
+  }
+}
+
+
+/******************************************************************************
+ *****************************************************************************/
+IoBinaryDataFile::Channel *IoBinaryDataFile::getChannel(const string &_key,
+                                                        const string &_section)
+{
+  unsigned long i;
+
+  for (i = 0; i < channelList.size(); i++) {
+    if ((channelList[i].key == _key) && (channelList[i].section == _section)) {
+      return(&channelList[i]);
+    }
+  }
+  return(NULL);
+}
+
+
+/******************************************************************************
+ *****************************************************************************/
+unsigned long IoBinaryDataFile::getNumSamples()
+{
+  try {
+    readHeader();
+    return(numSamples);
+  }
+  catch (...) {
+    cerr << "ERROR : UNKNOWN : ";
+    cerr << "IoBinaryDataFile::getNumSamples" << endl;
+    throw;
+  }
+}
+
+
+/******************************************************************************
+ *****************************************************************************/
+bool IoBinaryDataFile::channelExists(const string &_key, const string &_section)
+{
+  try {
+    readHeader();
+    return(getChannel(_key, _section) != NULL);
+  }
+  catch (...) {
+    cerr << "ERROR : UNKNOWN : ";
+    cerr << "IoBinaryDataFile::channelExists" << endl;
+    throw;
+  }
+}
+
+
+/******************************************************************************
+ *****************************************************************************/
+void IoBinaryDataFile::getKeys(vector<string> &_sections, vector<string> &_keys)
+{
+  unsigned long i;
+
+  try {
+    readHeader();
+    _sections.resize(channelList.size());
+    _keys.resize(channelList.size());
+    for (i = 0; i < channelList.size(); i++) {
+      _sections[i] = channelList[i].section;
+      _keys[i] = channelList[i].key;
+    }
+  }
+  catch (...) {
+    cerr << "ERROR : UNKNOWN : ";
+    cerr << "IoBinaryDataFile::getKeys" << endl;
+    throw;
+  }
+}
+
+
+/******************************************************************************
+ *****************************************************************************/
+void IoBinaryDataFile::getValues(double *_values, const string &_key,
+                                 const string &_section,
+                                 const unsigned long &_size,
+                                 const unsigned long &_stride,
+                                 const unsigned long &_first)
+{
+  Channel *p_channel;
+  double *p_buffer;
+  unsigned long i;
+
+  try {
+    readHeader();
+
+    /** find the channel *****************************************************/
+    p_channel = getChannel(_key, _section);
+    if (p_channel == NULL) {
+      throw IoDataFileExcept(ERROR_KEY_NOT_FOUND);
+    }
+    if (dataType == BINARY_DATA_TYPE_GORILLA) {
+      if (_first + _size > numSamples) {
+        throw IoDataFileExcept(ERROR_NOT_ENOUGH_VALUES);
+      }
+      decodeValues(*p_channel, _values, _size, _stride, _first);
+      return;
+    }
+    if (_first + _size > p_channel->size) {
+      throw IoDataFileExcept(ERROR_NOT_ENOUGH_VALUES);
+    }
+
+    /** read the values as a single block ************************************/
+    if (_stride == 1) {
+      p_buffer = _values;
+    }
+    else {
+      buffer.resize(_size);
+      p_buffer = buffer.data();
+    }
+    file.clear();
+    file.seekg(p_channel->offset + _first * sizeof(double));
+    if (! file.read(reinterpret_cast<char *>(p_buffer),
+                    _size * sizeof(double))) {
+      throw IoFileExcept(ERROR_COULD_NOT_READ_FILE);
+    }
+    if (! isLittleEndian()) {
+      for (i = 0; i < _size; i++) {
+        swapBytes(&p_buffer[i], sizeof(double));
+      }
+    }
+
+    /** scatter the values in case of a stride *******************************/
+    if (_stride != 1) {
+      for (i = 0; i < _size; i++) {
+        _values[i * _stride] = p_buffer[i];
+      }
+    }
+  }
+  catch (IoDataFileExcept &_e) {
+    if (_e.num == ERROR_KEY_NOT_FOUND) {
+      cerr << "ERROR : KEY_NOT_FOUND : ";
+    }
+    if (_e.num == ERROR_NOT_ENOUGH_VALUES) {
+      cerr << "ERROR : NOT_ENOUGH_VALUES : ";
+    }
+    cerr << "section = " << _section << " : ";
+    cerr << "key = " << _key << " : ";
+    cerr << "file = " << '"' << fileName << '"' << " : ";
+    cerr << "IoBinaryDataFile::getValues" << endl;
+    throw;
+  }
+  catch (IoFileExcept &_e) {
+    if (_e.num == ERROR_COULD_NOT_READ_FILE) {
+      cerr << "ERROR : COULD_NOT_READ_FILE : ";
+    }
+    cerr << "section = " << _section << " : ";
+    cerr << "key = " << _key << " : ";
+    cerr << "file = " << '"' << fileName << '"' << " : ";
+    cerr << "IoBinaryDataFile::getValues" << endl;
+    throw;
+  }
+  catch (...) {
+    cerr << "ERROR : UNKNOWN : ";
+    cerr << "IoBinaryDataFile::getValues" << endl;
+    throw;
+  }
+}
+
+
+/******************************************************************************
+ *****************************************************************************/
+void IoBinaryDataFile::decodeValues(Channel &_channel, double *_values,
+                                    const unsigned long &_size,
+                                    const unsigned long &_stride,
+                                    const unsigned long &_first)
+{
+  try {
+    /** load the encoded stream with the first read **************************/
+    if (_channel.stream.empty()) {
+      _channel.stream.resize(_channel.size);
+      file.clear();
+      file.seekg(_channel.offset);
+      if (! file.read(_channel.stream.data(), _channel.stream.size())) {
+        _channel.stream.clear();
+        throw IoFileExcept(ERROR_COULD_NOT_READ_FILE);
+      }
+      _channel.decoder.setStream(_channel.stream.data(),
+                                 _channel.stream.size());
+    }
+
+    /** continue where the last read ended or skip up to the first sample ****/
+    if (_channel.decoder.getNumValues() > _first) {
+      _channel.decoder.rewind();
+    }
+    if (! _channel.decoder.get(NULL, _first - _channel.decoder.getNumValues())
+        || ! _channel.decoder.get(_values, _size, _stride)) {
+      _channel.decoder.rewind();
+      throw IoBinaryDataFileExcept(ERROR_WRONG_FILE_FORMAT);
+    }
+  }
+  catch (IoFileExcept &_e) {
+    if (_e.num == ERROR_WRONG_FILE_FORMAT) {
+      cerr << "ERROR : WRONG_FILE_FORMAT : ";
+    }
+    cerr << "IoBinaryDataFile::decodeValues" << endl;
+    throw;
+  }
+  catch (...) {
+    cerr << "ERROR : UNKNOWN : ";
+    cerr << "IoBinaryDataFile::decodeValues" << endl;
+    throw;
+  }
+}
+
+
+/******************************************************************************
+ *****************************************************************************/
+void IoBinaryDataFile::getValues(valarray<double> &_values, const string &_key,
+                                 const string &_section,
+                                 const unsigned long &_size)
+{
+  try {
+    _values.resize((_size == 0) ? 1 : _size);
+    getValues(&_values[0], _key, _section, _values.size());
+  }
+  catch (...) {
+    cerr << "ERROR : UNKNOWN : ";
+    cerr << "IoBinaryDataFile::getValues" << endl;
+    throw;
+  }
+}
+
+
+/******************************************************************************
+ *****************************************************************************/
+void IoBinaryDataFile::convert(const string &_textFileName,
+                               const string &_binaryFileName,
+                               const uint32_t &_dataType)
+{
+  IoDataFile ioData(_textFileName, true);
+  vector<string> sectionList;
+  vector<string> keyList;
+  vector<string> sections;
+  vector<string> keys;
+  vector<valarray<double> > channels;
+  unsigned long samples;
+  unsigned long i;
+
+  try {
+    ioData.getValue(samples, "numSamples", "GLOBAL_DATA");
+    ioData.getKeys(sectionList, keyList);
+
+    /** any key apart from the global ones is a channel **********************/
+    for (i = 0; i < keyList.size(); i++) {
+      if (sectionList[i] == "GLOBAL_DATA") {
+        continue;
+      }
+      sections.push_back(sectionList[i]);
+      keys.push_back(keyList[i]);
+      channels.push_back(valarray<double>());
+      ioData.getValues(channels.back(), keyList[i], sectionList[i], samples);
+    }
+
+    write(_binaryFileName, samples, sections, keys, channels, _dataType);
+  }
+  catch (...) {
+    cerr << "ERROR : UNKNOWN : ";
+    cerr << "IoBinaryDataFile::convert" << endl;
+    throw;
+  }
+}
+
+
+/******************************************************************************
+ *****************************************************************************/
+void IoBinaryDataFile::write(const string &_fileName,
+                             const unsigned long &_numSamples,
+                             const vector<string> &_sections,
+                             const vector<string> &_keys,
+                             const vector<valarray<double> > &_channels,
+                             const uint32_t &_dataType)
+{
+  ofstream out;
+  vector<char> header;
+  vector<double> column;
+  vector<vector<char> > streams;
+  GorillaEncoder encoder;
+  string name;
+  unsigned long offset;
+  unsigned long size;
+  unsigned long i;
+  unsigned long k;
+  char *p_entry;
+
+  try {
+    if ((_dataType != BINARY_DATA_TYPE_FLOAT64)
+        && (_dataType != BINARY_DATA_TYPE_GORILLA)) {
+      throw IoBinaryDataFileExcept(ERROR_UNSUPPORTED_DATA_TYPE);
+    }
+
+    /** encode the channels in advance, since their sizes go to the header ***/
+    streams.resize(_channels.size());
+    column.resize(_numSamples);
+    for (i = 0; i < _channels.size(); i++) {
+      for (k = 0; k < _numSamples; k++) {
+        column[k] = (k < _channels[i].size()) ? _channels[i][k] : 0.0;
+      }
+      if (_dataType == BINARY_DATA_TYPE_GORILLA) {
+        for (k = 0; k < _numSamples; k++) {
+          encoder.put(column[k]);
+        }
+        streams[i] = encoder.finish();
+      }
+      else {
+        for (k = 0; (k < _numSamples) && ! isLittleEndian(); k++) {
+          swapBytes(&column[k], sizeof(double));
+        }
+        streams[i].assign(reinterpret_cast<const char *>(column.data()),
+                          reinterpret_cast<const char *>(column.data()
+                                                         + _numSamples));
+      }
+    }
+
+    /** build the header *****************************************************/
+    offset = BINARY_DATA_HEADER_SIZE + _channels.size()
+             * BINARY_DATA_CHANNEL_SIZE;
+    offset = (offset + BINARY_DATA_ALIGNMENT - 1) / BINARY_DATA_ALIGNMENT
+             * BINARY_DATA_ALIGNMENT;
+    header.assign(offset, 0);
+    memcpy(header.data(), BINARY_DATA_FILE_MAGIC.data(),
+           BINARY_DATA_FILE_MAGIC.size());
+    setNumber(&header[8], BINARY_DATA_FILE_VERSION);
+    setNumber(&header[12], _dataType);
+    setNumber(&header[16], static_cast<uint64_t>(_numSamples));
+    setNumber(&header[24], static_cast<uint32_t>(_channels.size()));
+    setNumber(&header[28], static_cast<uint32_t>(BINARY_DATA_CHANNEL_SIZE));
+    for (i = 0; i < _channels.size(); i++) {
+      name = _sections[i] + CHANNEL_SEPARATOR + _keys[i];
+      if (name.size() >= BINARY_DATA_CHANNEL_NAME_SIZE) {
+        throw IoBinaryDataFileExcept(ERROR_CHANNEL_NAME_TOO_LONG);
+      }
+      p_entry = &header[BINARY_DATA_HEADER_SIZE + i * BINARY_DATA_CHANNEL_SIZE];
+      memcpy(p_entry, name.data(), name.size());
+      size = (_dataType == BINARY_DATA_TYPE_GORILLA) ? streams[i].size()
+                                                     : _numSamples;
+      setNumber(p_entry + BINARY_DATA_CHANNEL_NAME_SIZE,
+                static_cast<uint64_t>(offset));
+      setNumber(p_entry + BINARY_DATA_CHANNEL_NAME_SIZE + sizeof(uint64_t),
+                static_cast<uint64_t>(size));
+      offset += streams[i].size();
+    }
+
+    /** write the header and the channels ************************************/
+    out.open(_fileName.c_str(), ios::out | ios::binary | ios::trunc);
+    if (! out.is_open()) {
+      throw IoFileExcept(ERROR_COULD_NOT_OPEN_FILE);
+    }
+    out.write(header.data(), header.size());
+    for (i = 0; i < streams.size(); i++) {
+      out.write(streams[i].data(), streams[i].size());
+    }
+    out.close();
+    if (out.fail()) {
+      throw IoBinaryDataFileExcept(ERROR_COULD_NOT_WRITE_FILE);
+    }
+  }
+  catch (IoFileExcept &_e) {
+    if (_e.num == ERROR_CHANNEL_NAME_TOO_LONG) {
+      cerr << "ERROR : CHANNEL_NAME_TOO_LONG : ";
+      cerr << "channel = " << name << " : ";
+    }
+    if (_e.num == ERROR_COULD_NOT_OPEN_FILE) {
+      cerr << "ERROR : COULD_NOT_OPEN_FILE : ";
+    }
+    if (_e.num == ERROR_COULD_NOT_WRITE_FILE) {
+      cerr << "ERROR : COULD_NOT_WRITE_FILE : ";
+    }
+    if (_e.num == ERROR_UNSUPPORTED_DATA_TYPE) {
+      cerr << "ERROR : UNSUPPORTED_DATA_TYPE : ";
+      cerr << "type = " << _dataType << " : ";
+    }
+    cerr << "file = " << '"' << _fileName << '"' << " : ";
+    cerr << "IoBinaryDataFile::write" << endl;
+    throw;
+  }
+  catch (...) {
+    cerr << "ERROR : UNKNOWN : ";
+    cerr << "IoBinaryDataFile::write" << endl;
+    throw;
+  }
+}
+
+
+/**############################################################################
+# NON MEMBER DEFINITIONS
+#############################################################################*/
+
+/******************************************************************************
+ *****************************************************************************/
+bool isBinaryDataFile(const string &_fileName)
+{
+  const string suffix = "." + BINARY_DATA_FILE_SUFFIX;
+
+  return((_fileName.size() > suffix.size())
+         && (_fileName.compare(_fileName.size() - suffix.size(),
+                               suffix.size(), suffix) == 0));
+}
+
+
+/**############################################################################
+# END OF FILE
+#############################################################################*/
@@ -0,0 +1,312 @@
+/**############################################################################
+#
+#
+# Copyright (C) 2021 by Christian Scheunert
+#
+# Email: christian.scheunert@tu-dresden.de
+#
+#############################################################################*/
+
+#ifndef __IOBINARYDATAFILE_H
+#define __IOBINARYDATAFILE_H
+
+
+/**############################################################################
+# INCLUDES
+#############################################################################*/
+
+#include "gorilla.h"
+#include "iodatafile.h"
+
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <valarray>
+#include <vector>
+
+
+/**############################################################################
+# NAMES
+#############################################################################*/
+
+using namespace std;
+
+
+/**############################################################################
+# DEFINES
+#############################################################################*/
+
+/******************************************************************************
+ * @ref IoBinaryDataFileExcept specific constant numbers for errors thrown by
+ * several functions of @ref IoBinaryDataFile. The numbers continue the ones
+ * of @ref IoDataFile, since those are thrown as well.
+ * @see
+ *****************************************************************************/
+#define ERROR_WRONG_FILE_FORMAT       5
+#define ERROR_UNSUPPORTED_DATA_TYPE   6
+#define ERROR_CHANNEL_NAME_TOO_LONG   7
+#define ERROR_COULD_NOT_WRITE_FILE    8
+
+
+/******************************************************************************
+ * The suffix of binary data files. Data files having this suffix are read by
+ * means of @ref IoBinaryDataFile instead of @ref IoDataFile.
+ * @see
+ *****************************************************************************/
+const string BINARY_DATA_FILE_SUFFIX = "bin";
+
+
+/******************************************************************************
+ * The layout of the binary data file header, see @ref IoBinaryDataFile.
+ * @see
+ *****************************************************************************/
+const string        BINARY_DATA_FILE_MAGIC        = string("QGDDATA\0", 8);
+const uint32_t      BINARY_DATA_FILE_VERSION      = 1;
+const uint32_t      BINARY_DATA_TYPE_FLOAT64      = 1;
+const uint32_t      BINARY_DATA_TYPE_GORILLA      = 2;
+const unsigned long BINARY_DATA_HEADER_SIZE       = 32;
+const unsigned long BINARY_DATA_CHANNEL_SIZE      = 64;
+const unsigned long BINARY_DATA_CHANNEL_NAME_SIZE = 48;
+const unsigned long BINARY_DATA_ALIGNMENT         = 64;
+
+
+/******************************************************************************
+ * Separates the section from the key within a channel name.
+ * @see
+ *****************************************************************************/
+const string CHANNEL_SEPARATOR = "/";
+
+
+/**############################################################################
+# CLASS DECLARATIONS
+#############################################################################*/
+
+/******************************************************************************
+ * A Exception class that refers to the @ref IoBinaryDataFile class.
+ * @see
+ *****************************************************************************/
+class IoBinaryDataFileExcept : public IoDataFileExcept  {
+public:
+  /****************************************************************************
+   * This construction function is used to set the number of exception.
+   * @param _num Number of error that has been found.
+   * @see
+   ***************************************************************************/
+  IoBinaryDataFileExcept(int _num);
+};
+
+
+/******************************************************************************
+ * The purpose of this class is to read and write the very same data that
+ * @ref IoDataFile reads from text files, but stored as binary columns. Any
+ * key of a section is a channel holding numSamples values. Reading a channel
+ * is therefore a single block read instead of parsing one line per value.
+ *
+ * The file has the following layout, where all numbers are little-endian:
+ *
+ * @li ------------------------------------------------------------------------
+ * @li offset  size  content
+ * @li      0     8  magic "QGDDATA\0"
+ * @li      8     4  version (uint32)
+ * @li     12     4  data type, 1 = float64, 2 = gorilla (uint32)
+ * @li     16     8  numSamples (uint64)
+ * @li     24     4  numChannels (uint32)
+ * @li     28     4  size of a channel entry, i.e. 64 (uint32)
+ * @li     32    64  channel entry 0: name "SECTION/key" zero padded to 48
+ * @li               bytes, offset (uint64) and size (uint64) of its data
+ * @li    ...
+ * @li      x        padding up to a multiple of 64 bytes
+ * @li      y        the channels' data, one contiguous column per channel
+ * @li ------------------------------------------------------------------------
+ *
+ * The size of a float64 channel is its number of values. A gorilla channel
+ * is compressed losslessly by means of @ref GorillaEncoder, its size is the
+ * number of bytes of the encoded stream. Such a channel is loaded once and
+ * decoded directly into the memory given with @ref getValues(...), reading
+ * it chunk by chunk continues decoding where the last chunk ended.
+ *
+ * Text data files are converted by means of @ref convert(...).
+ * @see
+ *****************************************************************************/
+class IoBinaryDataFile {
+  /****************************************************************************
+   * The Channel class stores the name and the position of a channel.
+   * @see
+   ***************************************************************************/
+  class Channel {
+  public:
+    string section;
+    string key;
+    uint64_t offset;
+    uint64_t size;
+    /** the encoded stream of a gorilla channel, loaded with the first read */
+    vector<char> stream;
+    GorillaDecoder decoder;
+  };
+  /** the file stream ********************************************************/
+  ifstream file;
+  /** the filename to read from **********************************************/
+  string fileName;
+  /** tracks whether the header of the current file has been read or not ****/
+  bool haveHeader;
+  /** the number of samples per channel **************************************/
+  unsigned long numSamples;
+  /** the data type of the channels ******************************************/
+  uint32_t dataType;
+  /** list of channels *******************************************************/
+  vector<Channel> channelList;
+  /** a buffer for reading channels that are stored with a stride ************/
+  vector<double> buffer;
+  /****************************************************************************
+   * Opens the file and reads its header, in case this has not been done yet.
+   * @throws IoBinaryDataFileExcept(ERROR_WRONG_FILE_FORMAT)
+   *         IoBinaryDataFileExcept(ERROR_UNSUPPORTED_DATA_TYPE)
+   * @see
+   ***************************************************************************/
+  void readHeader();
+  /****************************************************************************
+   * @return A pointer to the channel specified, otherwise NULL.
+   * @see
+   ***************************************************************************/
+  Channel *getChannel(const string &_key, const string &_section);
+  /****************************************************************************
+   * Decodes _size values of a gorilla channel starting at sample _first,
+   * see @ref getValues(...).
+   * @throws IoFileExcept(ERROR_COULD_NOT_READ_FILE)
+   *         IoBinaryDataFileExcept(ERROR_WRONG_FILE_FORMAT)
+   * @see
+   ***************************************************************************/
+  void decodeValues(Channel &_channel, double *_values,
+                    const unsigned long &_size, const unsigned long &_stride,
+                    const unsigned long &_first);
+public:
+  /****************************************************************************
+   * @see
+   ***************************************************************************/
+  IoBinaryDataFile(const string &_fileName = "");
+  /****************************************************************************
+   * @see
+   ***************************************************************************/
+  ~IoBinaryDataFile();
+  /****************************************************************************
+   * Set's the fileName member variable. The header is read again with the
+   * next access if the file name changes.
+   * @see
+   ***************************************************************************/
+  bool setFileName(const string &_fileName);
+  /****************************************************************************
+   * @return The number of samples stored per channel.
+   * @see
+   ***************************************************************************/
+  unsigned long getNumSamples();
+  /****************************************************************************
+   * @return True if the file includes the channel specified, otherwise false.
+   * @see
+   ***************************************************************************/
+  bool channelExists(const string &_key, const string &_section);
+  /****************************************************************************
+   * This function lists the channels in the order stored, in the same
+   * manner @ref IoDataFile::getKeys(...) lists the keys of a text data file.
+   * @param _sections The section names of the channels.
+   * @param _keys     The key names of the channels.
+   * @see
+   ***************************************************************************/
+  void getKeys(vector<string> &_sections, vector<string> &_keys);
+  /****************************************************************************
+   * This function reads _size values of a channel starting at sample _first
+   * into the memory _values points to. The values are stored _stride elements
+   * apart, thus a channel can directly be read into a row of a column major
+   * matrix.
+   * @throws IoDataFileExcept(ERROR_KEY_NOT_FOUND)
+   *         IoDataFileExcept(ERROR_NOT_ENOUGH_VALUES)
+   * @param _values  A pointer to the memory to store the first value in.
+   * @param _key     A reference to the name of the key to read from.
+   * @param _section A reference to the name of the section to read from.
+   * @param _size    The number of values to read.
+   * @param _stride  The distance between two values in memory.
+   * @param _first   The first sample to read.
+   * @see
+   ***************************************************************************/
+  void getValues(double *_values, const string &_key, const string &_section,
+                 const unsigned long &_size, const unsigned long &_stride = 1,
+                 const unsigned long &_first = 0);
+  /****************************************************************************
+   * This function reads all values of a channel in the same manner
+   * @ref IoDataFile::getValues(...) does.
+   * @see
+   ***************************************************************************/
+  void getValues(valarray<double> &_values, const string &_key,
+                 const string &_section = "", const unsigned long &_size = 0);
+  /****************************************************************************
+   * This function converts the text data file _textFileName into the binary
+   * data file _binaryFileName. The number of samples is taken from the key
+   * numSamples of the section GLOBAL_DATA, any key of the other sections is
+   * stored as a channel.
+   * @param _textFileName   The name of the text data file to read.
+   * @param _binaryFileName The name of the binary data file to write.
+   * @param _dataType       The data type to store the channels as.
+   * @see
+   ***************************************************************************/
+  static void convert(const string &_textFileName,
+                      const string &_binaryFileName,
+                      const uint32_t &_dataType = BINARY_DATA_TYPE_FLOAT64);
+  /****************************************************************************
+   * This function writes a binary data file.
+   * @throws IoBinaryDataFileExcept(ERROR_CHANNEL_NAME_TOO_LONG)
+   *         IoBinaryDataFileExcept(ERROR_UNSUPPORTED_DATA_TYPE)
+   *         IoBinaryDataFileExcept(ERROR_COULD_NOT_WRITE_FILE)
+   * @param _fileName   The name of the binary data file to write.
+   * @param _numSamples The number of samples per channel.
+   * @param _sections   The section names of the channels.
+   * @param _keys       The key names of the channels.
+   * @param _channels   The channels' values, each of size _numSamples.
+   * @param _dataType   The data type to store the channels as.
+   * @see
+   ***************************************************************************/
+  static void write(const string &_fileName, const unsigned long &_numSamples,
+                    const vector<string> &_sections,
+                    const vector<string> &_keys,
+                    const vector<valarray<double> > &_channels,
+                    const uint32_t &_dataType = BINARY_DATA_TYPE_FLOAT64);
+};
+
+
+/**############################################################################
+# INLINE MEMBER DEFINITIONS
+#############################################################################*/
+
+/******************************************************************************
+ *****************************************************************************/
+inline bool IoBinaryDataFile::setFileName(const string &_fileName)
+{
+  if ((_fileName != "") && (_fileName != fileName)) {
+    fileName = _fileName;
+    haveHeader = false;
+    return(true);
+  }
+  return(false);
+}
+
+
+/**############################################################################
+# TEMPLATE MEMBER DEFINITIONS
+#############################################################################*/
+
+
+/**############################################################################
+# NON MEMBER DECLARATIONS
+#############################################################################*/
+
+/******************************************************************************
+ * @return True if _fileName ends with "." + @ref BINARY_DATA_FILE_SUFFIX.
+ * @see
+ *****************************************************************************/
+bool isBinaryDataFile(const string &_fileName);
+
+
+/**############################################################################
+# END OF FILE
+#############################################################################*/
+
+#endif /* __IOBINARYDATAFILE_H ***********************************************/
@@ -111,7 +111,7 @@ IoConfigFile::Section* IoConfigFile::createSection(const string &_section) {
 			for (i = sectionList.begin(); i < sectionList.end(); i++) {
 				if (_section.compare(i->name) < 0) {
 					changedData = true;
-					sectionList.insert(i, section);
+					i = sectionList.insert(i, section);
 					return (&(*i));
 				}
 			}
@@ -161,7 +161,7 @@ IoConfigFile::Key* IoConfigFile::createKey(const string &_key,
 			for (i = p_section->keyList.begin(); i < p_section->keyList.end(); i++) {
 				if (_key.compare(i->name) < 0) {
 					changedData = true;
-					p_section->keyList.insert(i, key);
+					i = p_section->keyList.insert(i, key);
 					return (&(*i));
 				}
 			}
@@ -621,6 +621,19 @@ bool IoConfigFile::sectionExists(const string &_section) {
 	}
 }
 
+/******************************************************************************
+ *****************************************************************************/
+void IoConfigFile::getSections(vector<string> &_sections) {
+	unsigned long i;
+
+	_sections.clear();
+	for (i = 0; i < sectionList.size(); i++) {
+		if ((sectionList[i].name != "") || (sectionList[i].keyList.size() > 0)) {
+			_sections.push_back(sectionList[i].name);
+		}
+	}
+}
+
 /******************************************************************************
  *****************************************************************************/
 bool IoConfigFile::keyExists(const string &_key, const string &_section) {
@@ -349,6 +349,13 @@ public:
    * @see
    ***************************************************************************/
   bool sectionExists(const string &_section);
+  /****************************************************************************
+   * This function lists the names of all sections in the order kept, the
+   * unnamed global section is included if it holds any key.
+   * @param _sections A reference to the list to store the names in.
+   * @see
+   ***************************************************************************/
+  void getSections(vector<string> &_sections);
   /****************************************************************************
    * Given a @ref Key _key and a @ref Section _section, this function looks up
    * the key.
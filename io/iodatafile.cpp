@@ -39,11 +39,12 @@ IoDataFileExcept::IoDataFileExcept(int _num)
 
 /******************************************************************************
  *****************************************************************************/
-IoDataFile::IoDataFile(const string &_fileName)
+IoDataFile::IoDataFile(const string &_fileName, const bool &_useIndex)
 : IoSectionKeyFile(_fileName)
 {
   try {
-  
+    useIndex = _useIndex;
+    haveIndex = false;
   }
   catch (...) {
     cerr << "ERROR : UNKNOWN : ";
@@ -142,6 +143,100 @@ void IoDataFile::findKey(const string &_key, const string &_section)
 }
 
 
+/******************************************************************************
+******************************************************************************/
+void IoDataFile::buildIndex()
+{
+  string section;
+  string sectionName;
+  string key;
+  vector<string> sectionList;
+  bool indexSection;
+  KeyPosition keyPosition;
+
+  try {
+    keyIndex.clear();
+    keyOrder.clear();
+    indexSection = true;
+
+    while (! endOfFile()) {
+      readLine(line);
+
+      /** a new section starts, index only its first occurrence ***************/
+      if ((line.find(SECTION_PREFIX) == 0)
+          && (line.find(SECTION_POSTFIX) != string::npos)) {
+        section = line.substr(0, line.find(SECTION_POSTFIX)
+                              + SECTION_POSTFIX.size());
+        sectionName = section.substr(SECTION_PREFIX.size(), section.size()
+                                     - SECTION_PREFIX.size()
+                                     - SECTION_POSTFIX.size());
+        indexSection = (find(sectionList.begin(), sectionList.end(), section)
+                        == sectionList.end());
+        sectionList.push_back(section);
+      }
+
+      /** a key start tag, the key's data starts right at the next line *******/
+      else if (indexSection && (line.find(KEY_START_PREFIX) == 0)
+               && (line.find(KEY_END_PREFIX) != 0)
+               && (line.find(KEY_POSTFIX) != string::npos)) {
+        key = line.substr(0, line.find(KEY_POSTFIX) + KEY_POSTFIX.size());
+        if (keyIndex.find(convIndexName(key, section)) == keyIndex.end()) {
+          keyPosition.section = sectionName;
+          keyPosition.key = key.substr(KEY_START_PREFIX.size(),
+              key.size() - KEY_START_PREFIX.size() - KEY_POSTFIX.size());
+          keyPosition.position = getFilePosition();
+          keyPosition.lineNumber = lineNumber;
+          keyIndex[convIndexName(key, section)] = keyPosition;
+          keyOrder.push_back(convIndexName(key, section));
+        }
+      }
+    }
+    haveIndex = true;
+  }
+  catch (...) {
+    cerr << "ERROR : UNKNOWN : ";
+    cerr << "file = " << '"' << fileName << '"' << " : ";
+    cerr << "IoDataFile::buildIndex" << endl;
+    keyIndex.clear();
+    keyOrder.clear();
+    throw;
+  }
+}
+
+
+/******************************************************************************
+******************************************************************************/
+bool IoDataFile::seekKey(const string &_key, const string &_section)
+{
+  map<string, KeyPosition>::iterator p_keyPosition;
+
+  try {
+    /** scan the file once in case there is no index for it yet **************/
+    if (! haveIndex) {
+      buildIndex();
+    }
+
+    /** go to the first value of the key *************************************/
+    p_keyPosition = keyIndex.find(convIndexName(_key, _section));
+    if (p_keyPosition != keyIndex.end()) {
+      setFilePosition(p_keyPosition->second.position);
+      lineNumber = p_keyPosition->second.lineNumber;
+      return(true);
+    }
+
+    /** otherwise let the caller search the file from its top ****************/
+    setFilePosition(0);
+    lineNumber = 0;
+    return(false);
+  }
+  catch (...) {
+    cerr << "ERROR : UNKNOWN : ";
+    cerr << "IoDataFile::seekKey" << endl;
+    throw;
+  }
+}
+
+
 /******************************************************************************
  *****************************************************************************/
 void IoDataFile::setStringValues(const valarray<string> &_values,
@@ -167,7 +262,10 @@ void IoDataFile::getStringValues(valarray<string> &_values, const string &_key,
     openFileForRead();
 
     /** find the section and key *********************************************/
-    findKey(convStartKeyName(_key), convSectionName(_section));
+    if (! (useIndex
+           && seekKey(convStartKeyName(_key), convSectionName(_section)))) {
+      findKey(convStartKeyName(_key), convSectionName(_section));
+    }
 
     /** resize the output array **********************************************/
     if (_size == 0) {
@@ -222,6 +320,44 @@ void IoDataFile::getStringValues(valarray<string> &_values, const string &_key,
 }
 
 
+/******************************************************************************
+ *****************************************************************************/
+void IoDataFile::getKeys(vector<string> &_sections, vector<string> &_keys)
+{
+  unsigned long i;
+
+  try {
+    /** index the file if not done yet ***************************************/
+    if (! haveIndex) {
+      openFileForRead();
+      buildIndex();
+      closeFile();
+    }
+
+    /** copy the section and key names ***************************************/
+    _sections.resize(keyOrder.size());
+    _keys.resize(keyOrder.size());
+    for (i = 0; i < keyOrder.size(); i++) {
+      _sections[i] = keyIndex[keyOrder[i]].section;
+      _keys[i] = keyIndex[keyOrder[i]].key;
+    }
+
+    /** an index is only kept if the index mode is switched on ***************/
+    if (! useIndex) {
+      haveIndex = false;
+      keyIndex.clear();
+      keyOrder.clear();
+    }
+  }
+  catch (...) {
+    cerr << "ERROR : UNKNOWN : ";
+    cerr << "IoDataFile::getKeys" << endl;
+    closeFile();
+    throw;
+  }
+}
+
+
 /**############################################################################
 # NON MEMBER DEFINITIONS
 #############################################################################*/
@@ -17,9 +17,12 @@
 
 #include "iosectionkeyfile.h"
 
+#include <algorithm>
 #include <iostream>
+#include <map>
 #include <string>
 #include <valarray>
+#include <vector>
 
 
 /**############################################################################
@@ -91,6 +94,13 @@ public:
  * not be used and therefore not be loaded. Thus take care, calling one of the
  * @ref getValues functions will probably consume a lot of time.
  *
+ * In case a file is read key by key, each call of the @ref getValues
+ * functions scans the file from its top until the section and key requested
+ * have been found. For files with many large keys this can be avoided by
+ * switching on the index mode, see @ref setIndexMode(...). The first read
+ * access then scans the whole file once and records the position of every
+ * key start tag. Any further access directly seeks to the key requested.
+ *
  * An example of such a data file might look like this:
  * <Note, the braced x in the tags is only required for correct kdoc output>
  *
@@ -144,6 +154,30 @@ public:
  * @see
  *****************************************************************************/
 class IoDataFile : public IoSectionKeyFile {
+  /****************************************************************************
+   * The KeyPosition class stores where the data of a key starts, i.e. the
+   * position of the line following the key's start tag.
+   * @see
+   ***************************************************************************/
+  class KeyPosition {
+  public:
+    string section;
+    string key;
+    streampos position;
+    unsigned long lineNumber;
+  };
+  /** decides whether the key positions should be indexed or not *************/
+  bool useIndex;
+  /** tracks whether the index belongs to the current file or not ************/
+  bool haveIndex;
+  /** the key positions found, accessed by section and start tag name ********/
+  map<string, KeyPosition> keyIndex;
+  /** the index names of the keys in the order they appear within the file **/
+  vector<string> keyOrder;
+  /****************************************************************************
+   * @see
+   ***************************************************************************/
+  string convIndexName(const string &_key, const string &_section);
   /****************************************************************************
    * @see
    ***************************************************************************/
@@ -174,6 +208,25 @@ class IoDataFile : public IoSectionKeyFile {
    * @see
    ***************************************************************************/
   void findKey(const string &_key, const string &_section);
+  /****************************************************************************
+   * This function scans the open data file once from its top and records the
+   * position of any key start tag within the sections found. Only the first
+   * occurrence of a section is indexed, i.e. the keys are the very same
+   * @ref findKey(...) would find.
+   * @see
+   ***************************************************************************/
+  void buildIndex();
+  /****************************************************************************
+   * This function moves the read position of the open data file to the first
+   * value of the key and section specified. The index will be built in case
+   * it is not available for the current file.
+   * @return True if the key has been found within the index, otherwise false
+   *         and the read position is reset to the top of the file.
+   * @param _key     The start tag of the key to find.
+   * @param _section The name of section to find.
+   * @see
+   ***************************************************************************/
+  bool seekKey(const string &_key, const string &_section);
   /****************************************************************************
    * @see
    ***************************************************************************/
@@ -189,11 +242,35 @@ public:
   /****************************************************************************
    * @see
    ***************************************************************************/
-  IoDataFile(const string &_fileName = "");
+  IoDataFile(const string &_fileName = "", const bool &_useIndex = false);
   /****************************************************************************
    * @see
    ***************************************************************************/
   virtual ~IoDataFile();
+  /****************************************************************************
+   * Set's the fileName member variable. An index of the previous file is
+   * dropped if the file name changes.
+   * @see
+   ***************************************************************************/
+  virtual bool setFileName(const string &_fileName);
+  /****************************************************************************
+   * Switches the index mode on or off.
+   * @param _useIndex If true the file is scanned once and any @ref getValues
+   *                  call seeks directly to the key requested.
+   * @see
+   ***************************************************************************/
+  void setIndexMode(const bool &_useIndex);
+  /****************************************************************************
+   * This function returns the names of all sections and keys found within
+   * the data file in the order they appear. Only the first occurrence of a
+   * section is taken into account. The file is indexed for that purpose,
+   * even if the index mode is switched off.
+   * @param _sections A reference to an array to store the section names in.
+   * @param _keys     A reference to an array to store the key names in, where
+   *                  _keys[i] belongs to _sections[i].
+   * @see
+   ***************************************************************************/
+  void getKeys(vector<string> &_sections, vector<string> &_keys);
 };
 
 
@@ -201,6 +278,15 @@ public:
 # INLINE MEMBER DEFINITIONS
 #############################################################################*/
 
+/******************************************************************************
+ *****************************************************************************/
+inline string IoDataFile::convIndexName(const string &_key,
+                                        const string &_section)
+{
+  return(_section + _key);
+}
+
+
 /******************************************************************************
  *****************************************************************************/
 inline string IoDataFile::convStartKeyName(const string &_key)
@@ -217,6 +303,33 @@ inline string IoDataFile::convEndKeyName(const string &_key)
 }
 
 
+/******************************************************************************
+ *****************************************************************************/
+inline bool IoDataFile::setFileName(const string &_fileName)
+{
+  if (IoSectionKeyFile::setFileName(_fileName)) {
+    haveIndex = false;
+    keyIndex.clear();
+    keyOrder.clear();
+    return(true);
+  }
+  return(false);
+}
+
+
+/******************************************************************************
+ *****************************************************************************/
+inline void IoDataFile::setIndexMode(const bool &_useIndex)
+{
+  useIndex = _useIndex;
+  if (! useIndex) {
+    haveIndex = false;
+    keyIndex.clear();
+    keyOrder.clear();
+  }
+}
+
+
 /**############################################################################
 # TEMPLATE MEMBER DEFINITIONS
 #############################################################################*/
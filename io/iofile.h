@@ -159,6 +159,20 @@ protected:
    * @see
    ***************************************************************************/
   bool endOfFile();
+  /****************************************************************************
+   * Returns the current read position within the file, e.g. to come back to
+   * a certain line later on by means of @ref setFilePosition(...).
+   * @see
+   ***************************************************************************/
+  streampos getFilePosition();
+  /****************************************************************************
+   * Moves the read position to _position. Any end of file state is cleared
+   * before, thus a position gathered by @ref getFilePosition() can be reused
+   * even if the file has been read to its end in between.
+   * @param _position A position previously returned by @ref getFilePosition().
+   * @see
+   ***************************************************************************/
+  void setFilePosition(const streampos &_position);
   /****************************************************************************
    * @see
    ***************************************************************************/
@@ -209,6 +223,23 @@ inline bool IoFile::endOfFile()
 }
 
 
+/******************************************************************************
+ *****************************************************************************/
+inline streampos IoFile::getFilePosition()
+{
+  return(p_file->tellg());
+}
+
+
+/******************************************************************************
+ *****************************************************************************/
+inline void IoFile::setFilePosition(const streampos &_position)
+{
+  p_file->clear();
+  p_file->seekg(_position);
+}
+
+
 /******************************************************************************
  *****************************************************************************/
 inline bool IoFile::setFileName(const string &_fileName)
@@ -0,0 +1,713 @@
+/**############################################################################
+#
+#
+# Copyright (C) 2021 by Christian Scheunert
+#
+# Email: christian.scheunert@tu-dresden.de
+#
+#############################################################################*/
+
+/**############################################################################
+# INCLUDES
+#############################################################################*/
+
+#include "iomappeddatafile.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+/**############################################################################
+# DEFINES
+#############################################################################*/
+
+
+/**############################################################################
+# LOCAL DEFINITIONS
+#############################################################################*/
+
+/******************************************************************************
+ * Converts _string into a value by means of std::from_chars after checking it
+ * against the _permitted chars. A leading '+' is accepted like
+ * @ref Convert::toValue does, the whole string has to be consumed.
+ *****************************************************************************/
+template<class T> static void fromChars(T &_value, const string_view &_string,
+                                        const char *_permitted)
+{
+  string_view number = _string;
+  from_chars_result result;
+
+  if (number.find_first_not_of(_permitted) != string_view::npos) {
+    throw ConvertExcept(ERROR_NON_VALID_CHARS_IN_STRING);
+  }
+  if ((number.size() > 1) && (number[0] == '+')
+      && (number[1] != '+') && (number[1] != '-')) {
+    number.remove_prefix(1);
+  }
+  result = from_chars(number.data(), number.data() + number.size(), _value);
+  if ((result.ec != errc()) || (result.ptr != number.data() + number.size())) {
+    throw ConvertExcept(ERROR_CAN_NOT_CONVERT_TO_VALUE);
+  }
+}
+
+
+/******************************************************************************
+ * Returns the line starting at _position of the _size chars _data points to,
+ * trimmed by WHITE_SPACE, and moves _position to the following line.
+ *****************************************************************************/
+static string_view nextLine(const char *_data, const size_t &_size,
+                            size_t &_position)
+{
+  const char *p_end;
+  string_view line;
+  size_t first;
+
+  p_end = static_cast<const char *>(memchr(_data + _position, '\n',
+                                           _size - _position));
+  if (p_end == NULL) {
+    p_end = _data + _size;
+  }
+  line = string_view(_data + _position, p_end - (_data + _position));
+  _position = (p_end - _data) + 1;
+
+  first = line.find_first_not_of(WHITE_SPACE);
+  if (first == string_view::npos) {
+    return(line.substr(0, 0));
+  }
+  return(line.substr(first, line.find_last_not_of(WHITE_SPACE) - first + 1));
+}
+
+
+/******************************************************************************
+ * Converts the _size values found from _position on into _values, _stride
+ * elements apart. Errors are not reported but returned as false, thus
+ * several ranges can be converted at once.
+ *****************************************************************************/
+static bool convertRange(const char *_data, const size_t &_dataSize,
+                         size_t _position, double *_values,
+                         const unsigned long &_size,
+                         const unsigned long &_stride)
+{
+  string_view line;
+  unsigned long i;
+
+  try {
+    for (i = 0; i < _size; ) {
+      line = nextLine(_data, _dataSize, _position);
+      if (PERMITTED_CHARS_PER_LINE < line.size()) {
+        return(false);
+      }
+      if (! line.empty()) {
+        fromChars(_values[i * _stride], line, PERMITTED_FLOAT_CHARS);
+        i++;
+      }
+    }
+    return(true);
+  }
+  catch (...) {
+    return(false);
+  }
+}
+
+
+/**############################################################################
+# MEMBER DEFINITIONS
+#############################################################################*/
+
+/******************************************************************************
+ *****************************************************************************/
+IoMappedDataFile::IoMappedDataFile(const string &_fileName)
+{
+  try {
+    fileName = _fileName;
+    numThreads = 1;
+    isMapped = false;
+    p_data = NULL;
+    dataSize = 0;
+    position = 0;
+    lineNumber = 0;
+  }
+  catch (...) {
+    cerr << "ERROR : UNKNOWN : ";
+    cerr << "IoMappedDataFile::IoMappedDataFile" << endl;
+    throw;
+  }
+}
+
+
+/******************************************************************************
+ *****************************************************************************/
+IoMappedDataFile::~IoMappedDataFile()
+{
+  try {
+    unmapFile();
+  }
+  catch (...) {
+    cerr << "ERROR : UNKNOWN : ";
+    cerr << "IoMappedDataFile::~IoMappedDataFile" << endl;
+    throw;
+  }
+}
+
+
+/******************************************************************************
+ *****************************************************************************/
+void IoMappedDataFile::mapFile()
+{
+  int fileDescriptor;
+  struct stat fileStatus;
+  void *p_map;
+
+  try {
+    /** map the file once, an empty file is never mapped *********************/
+    if (isMapped) {
+      return;
+    }
+    if (fileName == "") {
+      throw IoFileExcept(ERROR_MISSING_FILE_NAME);
+    }
+    fileDescriptor = open(fileName.c_str(), O_RDONLY);
+    if (fileDescriptor < 0) {
+      throw IoFileExcept(ERROR_COULD_NOT_OPEN_FILE);
+    }
+    if (fstat(fileDescriptor, &fileStatus) != 0) {
+      close(fileDescriptor);
+      throw IoFileExcept(ERROR_COULD_NOT_OPEN_FILE);
+    }
+    dataSize = fileStatus.st_size;
+    if (dataSize > 0) {
+      p_map = mmap(NULL, dataSize, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+      if (p_map == MAP_FAILED) {
+        close(fileDescriptor);
+        dataSize = 0;
+        throw IoFileExcept(ERROR_COULD_NOT_OPEN_FILE);
+      }
+      madvise(p_map, dataSize, MADV_SEQUENTIAL);
+      p_data = static_cast<const char *>(p_map);
+    }
+    close(fileDescriptor);
+    isMapped = true;
+  }
+  catch (IoFileExcept &_e) {
+    if (_e.num == ERROR_MISSING_FILE_NAME) {
+      cerr << "ERROR : MISSING_FILE_NAME : ";
+    }
+    if (_e.num == ERROR_COULD_NOT_OPEN_FILE) {
+      cerr << "ERROR : COULD_NOT_OPEN_FILE : ";
+      cerr << "file = " << '"' << fileName << '"' << " : ";
+    }
+    cerr << "IoMappedDataFile::mapFile" << endl;
+    throw;
+  }
+  catch (...) {
+    cerr << "ERROR : UNKNOWN : ";
+    cerr << "IoMappedDataFile::mapFile" << endl;
+    throw;
+  }
+}
+
+
+/******************************************************************************
+ *****************************************************************************/
+void IoMappedDataFile::unmapFile()
+{
+  if (p_data != NULL) {
+    munmap(const_cast<char *>(p_data), dataSize);
+  }
+  isMapped = false;
+  p_data = NULL;
+  dataSize = 0;
+  line = string_view();
+  resumeList.clear();
+  rewind();
+}
+
+
+/******************************************************************************
+ *****************************************************************************/
+void IoMappedDataFile::readLine()
+{
+  try {
+    /** read and trim the current line ***************************************/
+    line = nextLine(p_data, dataSize, position);
+
+    /** update the line number counter ***************************************/
+    lineNumber++;
+
+    /** throw if the there are too many characters within that row ***********/
+    if (PERMITTED_CHARS_PER_LINE < line.size()) {
+      throw IoFileExcept(ERROR_TOO_MANY_CHARS_PER_LINE);
+    }
+  }
+  catch (IoFileExcept &_e) {
+    if (_e.num == ERROR_TOO_MANY_CHARS_PER_LINE) {
+      cerr << "ERROR : TOO_MANY_CHARS_PER_LINE : ";
+      cerr << "lineNumber = " << lineNumber << " : ";
+    }
+    cerr << "IoMappedDataFile::readLine" << endl;
+    throw;
+  }
+  catch (...) {
+    cerr << "ERROR : UNKNOWN : ";
+    cerr << "IoMappedDataFile::readLine" << endl;
+    throw;
+  }
+}
+
+
+/******************************************************************************
+******************************************************************************/
+void IoMappedDataFile::findSection(const string &_section)
+{
+  try {
+    while (true) {
+      if (endOfFile()) {
+        throw IoDataFileExcept(ERROR_SECTION_NOT_FOUND);
+      }
+      readLine();
+      if (string_view::npos != line.find(_section)) {
+        return;
+      }
+    }
+  }
+  catch (IoDataFileExcept &_e) {
+    if (_e.num == ERROR_SECTION_NOT_FOUND) {
+      cerr << "ERROR : SECTION_NOT_FOUND : ";
+      cerr << "section = " << _section << " : ";
+    }
+    cerr << "file = " << '"' << fileName << '"' << " : ";
+    cerr << "IoMappedDataFile::findSection" << endl;
+    throw;
+  }
+  catch (...) {
+    cerr << "ERROR : UNKNOWN : ";
+    cerr << "IoMappedDataFile::findSection" << endl;
+    throw;
+  }
+}
+
+
+/******************************************************************************
+******************************************************************************/
+void IoMappedDataFile::findKey(const string &_key, const string &_section)
+{
+  try {
+    /** find the section *****************************************************/
+    if (_section != "") {
+      findSection(_section);
+    }
+
+    /** find the key *********************************************************/
+    while (true) {
+      if (endOfFile()) {
+        throw IoDataFileExcept(ERROR_KEY_NOT_FOUND);
+      }
+      readLine();
+      if (string_view::npos != line.find(_key)) {
+        return;
+      }
+      if (line.find(SECTION_PREFIX) == 0) {
+        throw IoDataFileExcept(ERROR_KEY_NOT_FOUND);
+      }
+    }
+  }
+  catch (IoDataFileExcept &_e) {
+    if (_e.num == ERROR_KEY_NOT_FOUND) {
+      cerr << "ERROR : KEY_NOT_FOUND : ";
+      cerr << "section = " << _section << " : ";
+      cerr << "key = " << _key << " : ";
+    }
+    cerr << "file = " << '"' << fileName << '"' << " : ";
+    cerr << "IoMappedDataFile::findKey" << endl;
+    throw;
+  }
+  catch (...) {
+    cerr << "ERROR : UNKNOWN : ";
+    cerr << "IoMappedDataFile::findKey" << endl;
+    throw;
+  }
+}
+
+
+/******************************************************************************
+******************************************************************************/
+void IoMappedDataFile::readValueLine(const string &_endKey)
+{
+  do {
+    if (endOfFile()) {
+      throw IoDataFileExcept(ERROR_UNEXPECTED_END_OF_FILE);
+    }
+    readLine();
+    if (string_view::npos != line.find(_endKey)) {
+      throw IoDataFileExcept(ERROR_NOT_ENOUGH_VALUES);
+    }
+  } while (line.empty());
+}
+
+
+/******************************************************************************
+******************************************************************************/
+void IoMappedDataFile::toValue(double &_value)
+{
+  try {
+    fromChars(_value, line, PERMITTED_FLOAT_CHARS);
+  }
+  catch (ConvertExcept &_e) {
+    if (_e.num == ERROR_NON_VALID_CHARS_IN_STRING) {
+      cerr << "ERROR : NON_VALID_CHARS_IN_STRING : ";
+    }
+    if (_e.num == ERROR_CAN_NOT_CONVERT_TO_VALUE) {
+      cerr << "ERROR : CAN_NOT_CONVERT_TO_VALUE : ";
+    }
+    cerr << "string = " << line << " : ";
+    cerr << "lineNumber = " << lineNumber << " : ";
+    cerr << "IoMappedDataFile::toValue(double)" << endl;
+    throw;
+  }
+}
+
+
+/******************************************************************************
+******************************************************************************/
+void IoMappedDataFile::toValue(unsigned long &_value)
+{
+  try {
+    fromChars(_value, line, PERMITTED_UNSIGNED_CHARS);
+  }
+  catch (ConvertExcept &_e) {
+    if (_e.num == ERROR_NON_VALID_CHARS_IN_STRING) {
+      cerr << "ERROR : NON_VALID_CHARS_IN_STRING : ";
+    }
+    if (_e.num == ERROR_CAN_NOT_CONVERT_TO_VALUE) {
+      cerr << "ERROR : CAN_NOT_CONVERT_TO_VALUE : ";
+    }
+    cerr << "string = " << line << " : ";
+    cerr << "lineNumber = " << lineNumber << " : ";
+    cerr << "IoMappedDataFile::toValue(unsigned long)" << endl;
+    throw;
+  }
+}
+
+
+/******************************************************************************
+ *****************************************************************************/
+void IoMappedDataFile::getValue(unsigned long &_value, const string &_key,
+                                const string &_section)
+{
+  try {
+    mapFile();
+    rewind();
+    findKey(KEY_START_PREFIX + _key + KEY_POSTFIX,
+            SECTION_PREFIX + _section + SECTION_POSTFIX);
+    readValueLine(KEY_END_PREFIX + _key + KEY_POSTFIX);
+    toValue(_value);
+  }
+  catch (IoDataFileExcept &_e) {
+    if (_e.num == ERROR_UNEXPECTED_END_OF_FILE) {
+      cerr << "ERROR : UNEXPECTED_END_OF_FILE : ";
+    }
+    if (_e.num == ERROR_NOT_ENOUGH_VALUES) {
+      cerr << "ERROR : NOT_ENOUGH_VALUES : ";
+    }
+    cerr << "section = " << _section << " : ";
+    cerr << "key = " << _key << " : ";
+    cerr << "file = " << '"' << fileName << '"' << " : ";
+    cerr << "IoMappedDataFile::getValue" << endl;
+    throw;
+  }
+  catch (...) {
+    cerr << "ERROR : UNKNOWN : ";
+    cerr << "IoMappedDataFile::getValue" << endl;
+    throw;
+  }
+}
+
+
+/******************************************************************************
+ *****************************************************************************/
+void IoMappedDataFile::getValues(double *_values, const string &_key,
+                                 const string &_section,
+                                 const unsigned long &_size,
+                                 const unsigned long &_stride,
+                                 const unsigned long &_first)
+{
+  map<string, ResumePoint>::iterator p_resume;
+  ResumePoint resume;
+  string endKey;
+  unsigned long i;
+
+  try {
+    mapFile();
+    endKey = KEY_END_PREFIX + _key + KEY_POSTFIX;
+
+    /** continue where the last call stopped or find the section and key *****/
+    p_resume = resumeList.find(_section + endKey);
+    if ((p_resume != resumeList.end())
+        && (p_resume->second.first == _first)) {
+      position = p_resume->second.position;
+      lineNumber = p_resume->second.lineNumber;
+    }
+    else {
+      rewind();
+      findKey(KEY_START_PREFIX + _key + KEY_POSTFIX,
+              SECTION_PREFIX + _section + SECTION_POSTFIX);
+      for (i = 0; i < _first; i++) {
+        readValueLine(endKey);
+      }
+    }
+
+    /** convert the values right into the destination ************************/
+    if (! readValuesParallel(_values, _size, _stride)) {
+      for (i = 0; i < _size; i++) {
+        readValueLine(endKey);
+        toValue(_values[i * _stride]);
+      }
+    }
+
+    /** remember where the next values start *********************************/
+    resume.first = _first + _size;
+    resume.position = position;
+    resume.lineNumber = lineNumber;
+    resumeList[_section + endKey] = resume;
+  }
+  catch (IoDataFileExcept &_e) {
+    if (_e.num == ERROR_UNEXPECTED_END_OF_FILE) {
+      cerr << "ERROR : UNEXPECTED_END_OF_FILE : ";
+      cerr << "section = " << _section << " : ";
+      cerr << "key = " << _key << " : ";
+    }
+    if (_e.num == ERROR_NOT_ENOUGH_VALUES) {
+      cerr << "ERROR : NOT_ENOUGH_VALUES : ";
+      cerr << "section = " << _section << " : ";
+      cerr << "key = " << _key << " : ";
+    }
+    cerr << "file = " << '"' << fileName << '"' << " : ";
+    cerr << "IoMappedDataFile::getValues" << endl;
+    throw;
+  }
+  catch (...) {
+    cerr << "ERROR : UNKNOWN : ";
+    cerr << "file = " << '"' << fileName << '"' << " : ";
+    cerr << "IoMappedDataFile::getValues" << endl;
+    throw;
+  }
+}
+
+
+/******************************************************************************
+ *****************************************************************************/
+bool IoMappedDataFile::readValuesParallel(double *_values,
+                                          const unsigned long &_size,
+                                          const unsigned long &_stride)
+{
+  vector<size_t> rangePositions;
+  vector<unsigned long> rangeFirsts;
+  vector<future<void>> tasks;
+  vector<char> results;
+  unsigned long rangeSize;
+  unsigned long numValues;
+  unsigned long numLines;
+  size_t next;
+  string_view value;
+  unsigned long k;
+
+  if ((numThreads < 2) || (_size < numThreads * MIN_VALUES_PER_THREAD)) {
+    return(false);
+  }
+
+  /** find the lines of the values and where to split them, anything but a
+   * plain value line is left to the sequential conversion ******************/
+  rangeSize = (_size + numThreads - 1) / numThreads;
+  next = position;
+  numValues = 0;
+  numLines = 0;
+  while (numValues < _size) {
+    if (next >= dataSize) {
+      return(false);
+    }
+    if (rangePositions.size() * rangeSize == numValues) {
+      rangePositions.push_back(next);
+      rangeFirsts.push_back(numValues);
+    }
+    value = nextLine(p_data, dataSize, next);
+    numLines++;
+    if ((PERMITTED_CHARS_PER_LINE < value.size())
+        || (value.find(KEY_START_PREFIX) != string_view::npos)) {
+      return(false);
+    }
+    if (! value.empty()) {
+      numValues++;
+    }
+  }
+
+  /** convert the ranges concurrently, the last one by the calling thread ****/
+  results.assign(rangePositions.size(), false);
+  for (k = 0; k < rangePositions.size(); k++) {
+    auto convert = [this, &rangePositions, &rangeFirsts, &results, _values,
+                    _size, _stride, k] {
+      unsigned long last = (k + 1 < rangeFirsts.size()) ? rangeFirsts[k + 1]
+                                                        : _size;
+      results[k] = convertRange(p_data, dataSize, rangePositions[k],
+                                _values + rangeFirsts[k] * _stride,
+                                last - rangeFirsts[k], _stride);
+    };
+    if (k + 1 < rangePositions.size()) {
+      tasks.push_back(submit(convert));
+    }
+    else {
+      convert();
+    }
+  }
+  for (future<void> &task : tasks) {
+    task.wait();
+  }
+  for (future<void> &task : tasks) {
+    task.get();
+  }
+  for (k = 0; k < results.size(); k++) {
+    if (! results[k]) {
+      return(false);
+    }
+  }
+
+  /** continue behind the last value **************************************/
+  position = next;
+  lineNumber += numLines;
+  return(true);
+}
+
+
+/******************************************************************************
+ *****************************************************************************/
+void IoMappedDataFile::getValues(valarray<double> &_values, const string &_key,
+                                 const string &_section,
+                                 const unsigned long &_size)
+{
+  try {
+    _values.resize((_size == 0) ? 1 : _size);
+    getValues(&_values[0], _key, _section, _values.size());
+  }
+  catch (...) {
+    cerr << "ERROR : UNKNOWN : ";
+    cerr << "IoMappedDataFile::getValues" << endl;
+    throw;
+  }
+}
+
+
+/******************************************************************************
+ *****************************************************************************/
+void IoMappedDataFile::scanKeys(vector<KeyPosition> &_keys)
+{
+  string_view section;
+  string_view key;
+  string endKey;
+  vector<string> sectionList;
+  vector<string> keyList;
+  bool scanSection;
+  KeyPosition keyPosition;
+  double value;
+
+  try {
+    mapFile();
+    rewind();
+    _keys.clear();
+    scanSection = true;
+
+    while (! endOfFile()) {
+      readLine();
+
+      /** a new section starts, scan only its first occurrence ****************/
+      if ((line.find(SECTION_PREFIX) == 0)
+          && (line.find(SECTION_POSTFIX) != string_view::npos)) {
+        section = line.substr(SECTION_PREFIX.size(), line.find(SECTION_POSTFIX)
+                              - SECTION_PREFIX.size());
+        scanSection = (find(sectionList.begin(), sectionList.end(), section)
+                       == sectionList.end());
+        sectionList.push_back(string(section));
+        keyList.clear();
+        continue;
+      }
+
+      /** a key start tag, the key's data starts right at the next line *******/
+      if (! scanSection || (line.find(KEY_START_PREFIX) != 0)
+          || (line.find(KEY_END_PREFIX) == 0)
+          || (line.find(KEY_POSTFIX) == string_view::npos)) {
+        continue;
+      }
+      key = line.substr(KEY_START_PREFIX.size(), line.find(KEY_POSTFIX)
+                        - KEY_START_PREFIX.size());
+      if (find(keyList.begin(), keyList.end(), key) != keyList.end()) {
+        continue;
+      }
+      keyList.push_back(string(key));
+      keyPosition.section = string(section);
+      keyPosition.key = string(key);
+      keyPosition.position = position;
+      keyPosition.lineNumber = lineNumber;
+      keyPosition.numValues = 0;
+      keyPosition.minimum = 0.0;
+      keyPosition.maximum = 0.0;
+
+      /** convert any value up to the end tag, any other end tag or the end
+       * of the file ends the values as well, since no value could be read
+       * beyond it ***********************************************************/
+      endKey = KEY_END_PREFIX + keyPosition.key + KEY_POSTFIX;
+      while (! endOfFile()) {
+        readLine();
+        if ((string_view::npos != line.find(endKey))
+            || (line.find(KEY_END_PREFIX) == 0)) {
+          break;
+        }
+        if (line.empty()) {
+          continue;
+        }
+        toValue(value);
+        if ((keyPosition.numValues == 0) || (value < keyPosition.minimum)) {
+          keyPosition.minimum = value;
+        }
+        if ((keyPosition.numValues == 0) || (value > keyPosition.maximum)) {
+          keyPosition.maximum = value;
+        }
+        keyPosition.numValues++;
+      }
+      _keys.push_back(keyPosition);
+    }
+  }
+  catch (...) {
+    cerr << "ERROR : UNKNOWN : ";
+    cerr << "file = " << '"' << fileName << '"' << " : ";
+    cerr << "IoMappedDataFile::scanKeys" << endl;
+    throw;
+  }
+}
+
+
+/******************************************************************************
+ *****************************************************************************/
+void IoMappedDataFile::setKeyPosition(const KeyPosition &_keyPosition)
+{
+  ResumePoint resume;
+
+  resume.first = 0;
+  resume.position = _keyPosition.position;
+  resume.lineNumber = _keyPosition.lineNumber;
+  resumeList[_keyPosition.section + KEY_END_PREFIX + _keyPosition.key
+             + KEY_POSTFIX] = resume;
+}
+
+
+/**############################################################################
+# NON MEMBER DEFINITIONS
+#############################################################################*/
+
+
+/**############################################################################
+# END OF FILE
+#############################################################################*/
@@ -0,0 +1,337 @@
+/**############################################################################
+#
+#
+# Copyright (C) 2021 by Christian Scheunert
+#
+# Email: christian.scheunert@tu-dresden.de
+#
+#############################################################################*/
+
+#ifndef __IOMAPPEDDATAFILE_H
+#define __IOMAPPEDDATAFILE_H
+
+
+/**############################################################################
+# INCLUDES
+#############################################################################*/
+
+#include "convert.h"
+#include "iodatafile.h"
+
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <map>
+#include <string>
+#include <string_view>
+#include <valarray>
+#include <vector>
+
+
+/**############################################################################
+# NAMES
+#############################################################################*/
+
+using namespace std;
+
+
+/**############################################################################
+# DEFINES
+#############################################################################*/
+
+/******************************************************************************
+ * The minimum number of values converted per thread, fewer values are not
+ * worth handing to another thread.
+ * @see
+ *****************************************************************************/
+const unsigned long MIN_VALUES_PER_THREAD = 16384;
+
+
+/**############################################################################
+# CLASS DECLARATIONS
+#############################################################################*/
+
+/******************************************************************************
+ * The purpose of this class is to read the very same text data files as
+ * @ref IoDataFile does, but as fast as possible. The whole file is mapped
+ * into memory and walked line by line by means of string views, thus no line
+ * is copied. Values are converted by std::from_chars directly into the
+ * memory given by the caller.
+ *
+ * Sections and keys are searched in the same manner @ref IoDataFile does,
+ * any value is checked against the permitted chars of @ref Convert and
+ * errors are reported the same way, including the line number.
+ *
+ * The file stays mapped until another file name is set or the object is
+ * destroyed.
+ * @see
+ *****************************************************************************/
+class IoMappedDataFile {
+public:
+  /****************************************************************************
+   * Queues a task on the threads converting the values of a key, the future
+   * returned gets ready once the task has finished.
+   * @see
+   ***************************************************************************/
+  typedef function<future<void>(function<void()>)> Submit;
+  /****************************************************************************
+   * The KeyPosition class describes a key of the file as found by
+   * @ref scanKeys(...): where its values start, how many there are and their
+   * range.
+   * @see
+   ***************************************************************************/
+  class KeyPosition {
+  public:
+    string section;
+    string key;
+    size_t position;
+    unsigned long lineNumber;
+    unsigned long numValues;
+    double minimum;
+    double maximum;
+  };
+private:
+  /****************************************************************************
+   * The ResumePoint class stores where the values of a key following the
+   * ones read last start, thus a key can be read chunk by chunk without
+   * searching the file again.
+   * @see
+   ***************************************************************************/
+  class ResumePoint {
+  public:
+    unsigned long first;
+    size_t position;
+    unsigned long lineNumber;
+  };
+  /** the filename to read from **********************************************/
+  string fileName;
+  /** the number of threads converting the values of a key ******************/
+  unsigned numThreads;
+  /** queues the ranges of values converted by other threads *****************/
+  Submit submit;
+  /** tracks whether the current file has been mapped or not ****************/
+  bool isMapped;
+  /** the first char of the mapped file, NULL for an empty file **************/
+  const char *p_data;
+  /** the size of the mapped file ********************************************/
+  size_t dataSize;
+  /** the offset of the next line to be read *********************************/
+  size_t position;
+  /** the line read last *****************************************************/
+  string_view line;
+  /** counter for the line number ********************************************/
+  unsigned long lineNumber;
+  /** the resume points by section and key ***********************************/
+  map<string, ResumePoint> resumeList;
+  /****************************************************************************
+   * Maps the file into memory, in case this has not been done yet.
+   * @throws IoFileExcept(ERROR_MISSING_FILE_NAME)
+   *         IoFileExcept(ERROR_COULD_NOT_OPEN_FILE)
+   * @see
+   ***************************************************************************/
+  void mapFile();
+  /****************************************************************************
+   * Unmaps the file if mapped.
+   * @see
+   ***************************************************************************/
+  void unmapFile();
+  /****************************************************************************
+   * Moves back to the first line of the file.
+   * @see
+   ***************************************************************************/
+  void rewind();
+  /****************************************************************************
+   * @see
+   ***************************************************************************/
+  bool endOfFile();
+  /****************************************************************************
+   * Reads the next line into @ref line, trimmed by WHITE_SPACE the same way
+   * @ref IoFile::readLine does.
+   * @throws IoFileExcept(ERROR_TOO_MANY_CHARS_PER_LINE)
+   * @see
+   ***************************************************************************/
+  void readLine();
+  /****************************************************************************
+   * This function is used to find a section within the data file, see
+   * @ref IoDataFile::findSection.
+   * @throws IoDataFileExcept(ERROR_SECTION_NOT_FOUND)
+   * @see
+   ***************************************************************************/
+  void findSection(const string &_section);
+  /****************************************************************************
+   * This function is used to find a key within the section and data file
+   * specified, see @ref IoDataFile::findKey.
+   * @throws IoDataFileExcept(ERROR_KEY_NOT_FOUND)
+   * @see
+   ***************************************************************************/
+  void findKey(const string &_key, const string &_section);
+  /****************************************************************************
+   * Reads the next value of a key into @ref line.
+   * @throws IoDataFileExcept(ERROR_UNEXPECTED_END_OF_FILE)
+   *         IoDataFileExcept(ERROR_NOT_ENOUGH_VALUES)
+   * @param _endKey The end tag of the key.
+   * @see
+   ***************************************************************************/
+  void readValueLine(const string &_endKey);
+  /****************************************************************************
+   * Converts @ref line into a value.
+   * @throws ConvertExcept(ERROR_NON_VALID_CHARS_IN_STRING)
+   *         ConvertExcept(ERROR_CAN_NOT_CONVERT_TO_VALUE)
+   * @see
+   ***************************************************************************/
+  void toValue(double &_value);
+  /****************************************************************************
+   * @see
+   ***************************************************************************/
+  void toValue(unsigned long &_value);
+  /****************************************************************************
+   * Converts the next _size values concurrently. The lines are walked once
+   * to split them into @ref numThreads ranges of known values, which are
+   * converted into disjoint slices of _values by means of @ref submit, the
+   * last one by the calling thread. Nothing is reported here, in
+   * case of too few values, end tags, overlong lines or invalid values it
+   * returns false without moving on, thus the sequential conversion reports
+   * the very same errors.
+   * @return True if all values have been converted.
+   * @see
+   ***************************************************************************/
+  bool readValuesParallel(double *_values, const unsigned long &_size,
+                          const unsigned long &_stride);
+public:
+  /****************************************************************************
+   * @see
+   ***************************************************************************/
+  IoMappedDataFile(const string &_fileName = "");
+  /****************************************************************************
+   * @see
+   ***************************************************************************/
+  ~IoMappedDataFile();
+  /****************************************************************************
+   * Set's the fileName member variable. The previous file is unmapped if the
+   * file name changes.
+   * @see
+   ***************************************************************************/
+  bool setFileName(const string &_fileName);
+  /****************************************************************************
+   * Set's the number of threads converting the values of a key and the
+   * function queuing their tasks, e.g. on a thread pool of the caller, as
+   * does any thread converting the values of another key or file. 1 or no
+   * function converts them sequentially.
+   * @see
+   ***************************************************************************/
+  void setNumThreads(const unsigned &_numThreads, const Submit &_submit);
+  /****************************************************************************
+   * This function reads a single unsigned value, e.g. the number of samples.
+   * @param _value   The variable to store the value in.
+   * @param _key     A reference to the name of the key to read from.
+   * @param _section A reference to the name of the section to read from.
+   * @see
+   ***************************************************************************/
+  void getValue(unsigned long &_value, const string &_key,
+                const string &_section = "");
+  /****************************************************************************
+   * This function reads _size values of a key starting at value _first into
+   * the memory _values points to. The values are stored _stride elements
+   * apart, thus a key can directly be read into a row of a column major
+   * matrix. Reading a key chunk by chunk, i.e. _first being the value
+   * following the ones read last, continues right where the last call
+   * stopped.
+   * @param _values  A pointer to the memory to store the first value in.
+   * @param _key     A reference to the name of the key to read from.
+   * @param _section A reference to the name of the section to read from.
+   * @param _size    The number of values to read.
+   * @param _stride  The distance between two values in memory.
+   * @param _first   The first value to read.
+   * @see
+   ***************************************************************************/
+  void getValues(double *_values, const string &_key, const string &_section,
+                 const unsigned long &_size, const unsigned long &_stride = 1,
+                 const unsigned long &_first = 0);
+  /****************************************************************************
+   * This function reads the values of a key in the same manner
+   * @ref IoDataFile::getValues(...) does.
+   * @see
+   ***************************************************************************/
+  void getValues(valarray<double> &_values, const string &_key,
+                 const string &_section = "", const unsigned long &_size = 0);
+  /****************************************************************************
+   * This function walks the whole file once and lists any key in the order
+   * found, only the first occurrence of a section respectively key counts.
+   * Every value is converted, thus a damaged value fails here, while a key
+   * cut short just counts the values found.
+   * @throws ConvertExcept(ERROR_NON_VALID_CHARS_IN_STRING)
+   *         ConvertExcept(ERROR_CAN_NOT_CONVERT_TO_VALUE)
+   * @param _keys The list of keys found.
+   * @see
+   ***************************************************************************/
+  void scanKeys(vector<KeyPosition> &_keys);
+  /****************************************************************************
+   * This function tells where the values of a key start, e.g. as found by
+   * an earlier @ref scanKeys(...). Reading the key from its first value on
+   * starts right there instead of searching the file.
+   * @see
+   ***************************************************************************/
+  void setKeyPosition(const KeyPosition &_keyPosition);
+};
+
+
+/**############################################################################
+# INLINE MEMBER DEFINITIONS
+#############################################################################*/
+
+/******************************************************************************
+ *****************************************************************************/
+inline bool IoMappedDataFile::endOfFile()
+{
+  return(position >= dataSize);
+}
+
+
+/******************************************************************************
+ *****************************************************************************/
+inline void IoMappedDataFile::rewind()
+{
+  position = 0;
+  lineNumber = 0;
+}
+
+
+/******************************************************************************
+ *****************************************************************************/
+inline void IoMappedDataFile::setNumThreads(const unsigned &_numThreads,
+                                            const Submit &_submit)
+{
+  numThreads = ((_numThreads > 0) && _submit) ? _numThreads : 1;
+  submit = _submit;
+}
+
+
+/******************************************************************************
+ *****************************************************************************/
+inline bool IoMappedDataFile::setFileName(const string &_fileName)
+{
+  if ((_fileName != "") && (_fileName != fileName)) {
+    unmapFile();
+    fileName = _fileName;
+    return(true);
+  }
+  return(false);
+}
+
+
+/**############################################################################
+# TEMPLATE MEMBER DEFINITIONS
+#############################################################################*/
+
+
+/**############################################################################
+# NON MEMBER DECLARATIONS
+#############################################################################*/
+
+
+/**############################################################################
+# END OF FILE
+#############################################################################*/
+
+#endif /* __IOMAPPEDDATAFILE_H ***********************************************/
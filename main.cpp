@@ -23,61 +23,58 @@
 #include <iostream>
 #include <string>
 #include <valarray>
-#include <deque>
 #include <list>
-#include <random>
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <thread>
 
 #include "./tools/quaternion/quaternion.hpp"
-#include "./fusion/wilsonfusionblock.hpp"
-#include "./fusion/madgwick-original.hpp"
-#include "./fusion/qgdfusionblock.hpp"
+#include "./fusion/batchfusionblock.hpp"
+#include "./fusion/batchfusioncheck.hpp"
 #include "./fusion/madgwickfusionblock.hpp"
 
+#include "./tools/common/aggregation.hpp"
 #include "./tools/common/csv_writer.hpp"
+#include "./tools/common/dataset.hpp"
+#include "./tools/common/datasetcache.hpp"
+#include "./tools/common/datasetcatalog.hpp"
+#include "./tools/common/philox.hpp"
+#include "./tools/common/resultsink.hpp"
+#include "./tools/common/resultstore.hpp"
+#include "./tools/common/threadpool.hpp"
+#include "./tools/common/turnstile.hpp"
+#include "./tools/common/workstealingpool.hpp"
 #include "./io/convert.h"
 #include "./io/ioconfigfile.h"
 #include "./io/iodirectory.h"
-#include "./io/iodatafile.h"
+#include "./io/iobinarydatafile.h"
 #include "./io/iooption.h"
 #include "./sense.h"
 
-/**############################################################################
- # OBJECTS
- #############################################################################*/
-
-IoDataFile ioData_;
-IoConfigFile ioConf;
-IoDirectory ioDir;
-
-std::uniform_real_distribution<double> unif(0,1);
-std::default_random_engine re;
-
-/**############################################################################
- # VARIABLES
- #############################################################################*/
-
-unsigned numSamples_;
-valarray<double> tmpSamples;
-
-Mat<double> gyroData_, quatData_, gyroData_smooth, accData_smooth, magData_smooth;
-Mat<double> accData_;
-Mat<double> magData_;
-Col<double> timeData_;
+/*************************************************************************
+ * define  folders
+ ***********************************************************************/
+const string folderIn = "ExampleData/";
+const string folderOut = "Results/";
 
-deque<Col<double>::fixed<4>> buffer;
-deque<double> bufferScalar;
+/** the number of samples of any beta value run by a single task ***********/
+const unsigned SWEEP_BLOCK_SIZE = 1024;
 
-Quaternion qM1_, qM2_, qW_, qQ_, q_conj_, q_help_;
-Quaternion gyro_, acc_, mag_, gyro_smooth, acc_smooth, mag_smooth;
-Quaternion qTrue_, qTrue_conj, qQGD_conj, qWilson_conj, q_mdw1_conj, q_mdw2_conj;
-Quaternion acc_mdw, mag_mdw;
-Quaternion magRef_;
-Quaternion q_relative_;
+/** the algorithms of any beta value, the lane groups of each one are run as
+ * tasks of their own, and their cost per sample relative to QGD as measured */
+enum {SWEEP_MADGWICK = BatchFusionBlock::MADGWICK,
+	SWEEP_WILSON = BatchFusionBlock::WILSON, SWEEP_QGD = BatchFusionBlock::QGD,
+	SWEEP_NUM_ALGORITHMS};
+const double SWEEP_ALGORITHM_COST[SWEEP_NUM_ALGORITHMS] = {1.03, 1.07, 1.0};
 
-arma::Col<double>::fixed<3> anglesQ_, anglesW_, anglesT_, anglesM1_, anglesM2_, u;
-Col<double> beta_;
+/** input user inclination for MDW1 algorithm ******************************/
+const Quaternion SWEEP_MAG_REF(0,0.391801903,0,0.920049601);
 
-double samplingTime_;
+/** the batched fusion algorithms are checked on as many samples and have to
+ * agree with the scalar ones up to the tolerance ***************************/
+const unsigned CHECK_NUM_SAMPLES = 1000;
+const double CHECK_TOLERANCE = 1e-9;
 
 /****************************************************************************
 ***************************************************************************/
@@ -102,38 +99,18 @@ vector<double> genBeta(double first, double last)
 	return betas;
 }
 
-/****************************************************************************
- * moving average filter
-***************************************************************************/
-void movingAvg(Mat<double> &data, unsigned int filterSize){
-	Col<double>::fixed<4> avg;
-	for(unsigned int k=0; k<numSamples_; k++){
-	    if(k == 0){
-	    	buffer.clear();
-	    	avg = {0,0,0,0};
-	    }
-		avg += data.col(k)/filterSize;
-		buffer.push_front(data.col(k));
-		if(buffer.size() == filterSize){
-			avg -= buffer.back()/filterSize;
-			data.submat(0,k,3,k) = avg;
-			buffer.pop_back();
-		}
-	}
-}
-
 /****************************************************************************
  * convert frame of a quaternion q representing acc/mag measurement to adapt
  * the original Madgwick result representation to Wilson and QGD-OE
  * representation
 ***************************************************************************/
 void convertFrame(Quaternion &q){
-	  q_conj_ = Quaternion(0,1,0,0);
-	  q_help_ = q;
-	  q_help_ *= q_conj_;
-	  q_conj_.to_conj();
-	  q_conj_*=q_help_;
-	  q = q_conj_;
+	  Quaternion q_conj = Quaternion(0,1,0,0);
+	  Quaternion q_help = q;
+	  q_help *= q_conj;
+	  q_conj.to_conj();
+	  q_conj*=q_help;
+	  q = q_conj;
 }
 
 void deleteDirectoryContents(const std::string& dir_path)
@@ -145,342 +122,805 @@ void deleteDirectoryContents(const std::string& dir_path)
 /****************************************************************************
  * calculate equivalemt magnetometer measurement quaternion v_m = v_a × v_m = - v_m × v_a
  ***************************************************************************/
-void MagEquivalent()
+void MagEquivalent(Quaternion &mag, const Quaternion &acc)
 {
-	mag_.cross(acc_);
-	mag_.to_conj();
-	mag_.to_normalized();
+	mag.cross(acc);
+	mag.to_conj();
+	mag.to_normalized();
 }
 
-/** get random quaternion that represents rotation around a random axis by u
- * by a random angle theta, when |theta| < 10 degrees **/
-Quaternion getRandomQuaternion()
+/****************************************************************************
+ * convert text data files to binary data files next to them, e.g.
+ * gyro_0000.dat -> gyro_0000.bin, optionally compressed losslessly
+ ***************************************************************************/
+void convertDataFile(const string &_fileName, const bool _compress)
 {
-   for(unsigned int i=0;i<3;i++){
-		   u(i) = unif(re);
-   }
-   double theta = unif(re)*10; // random angle between -10 and 10 degrees
-   theta = theta*pi()/180; // convert angle from degrees to radians
-   Quaternion random_quat = Quaternion(u, theta); // construct quaternion from axis and angle
-   return random_quat;
+	string binFileName = _fileName.substr(0, _fileName.rfind('.')) + "."
+			+ BINARY_DATA_FILE_SUFFIX;
+	IoBinaryDataFile::convert(_fileName, binFileName, _compress ?
+			BINARY_DATA_TYPE_GORILLA : BINARY_DATA_TYPE_FLOAT64);
+	std::cout << "Converted " << _fileName << " to " << binFileName << std::endl;
 }
 
-int runFusions(const string &_confFileName) {
-	string Mode, DataSource, GyroData, AccData, MagData, QuatData,QuatDataResult,EulerDataResult;
-//	const string Mode = argv[1];
-//	const string DataSource = argv[2];
-//	const string i = argv[3];
+/****************************************************************************
+ * the sensor samples the fusion algorithms are run with, derived from a sample
+ * of a recording, the same for all beta values
+ ***************************************************************************/
+struct SensorSample {
+	Quaternion qTrue, gyro, acc, mag, acc_mdw, mag_mdw;
+};
 
-	/** load the configuration file ******************************************/
-	ioConf.loadFile(_confFileName, false);
+/****************************************************************************
+ * derive the sensor samples of sample i of data
+ ***************************************************************************/
+void prepareSample(const Dataset &data, const unsigned i,
+		const string &DataSource, SensorSample &sample)
+{
+	Quaternion qTrue_conj;
 
-	/** get config data from global section **********************************/
-	ioConf.getValue(Mode, "Mode");
-	ioConf.getValue(DataSource, "DataSource");
-	ioConf.getValue(GyroData, "GyroData");
-	ioConf.getValue(AccData, "AccData");
-	ioConf.getValue(MagData, "MagData");
-	ioConf.getValue(QuatData, "QuatData");
-	ioConf.getValue(QuatDataResult, "QuatDataResult");
-	ioConf.getValue(EulerDataResult, "EulerDataResult");
+	sample.qTrue = data.quat.col(i);
+	/** get samples from sensors ******************************************/
+	sample.gyro = data.gyro.col(i);
+	sample.gyro *= pi() / 180; // convert gyro readings from deg/s to rad/s
+//	sample.acc = data.acc.col(i);
 
-	/*************************************************************************
-	 * define  folders
-	 ***********************************************************************/
-	const string folderIn = "ExampleData/";
-	const string folderOut = "Results/";
+	//*** get true acc measurement from true quaternion ***//
+	sample.acc = Quaternion(0,0,0,-1);
+	qTrue_conj = sample.qTrue;
+	qTrue_conj.to_conj();
+	sample.acc *= sample.qTrue;
+	qTrue_conj *= sample.acc;
+	sample.acc = qTrue_conj;
 
-	magRef_ = Quaternion(0,0.391801903,0,0.920049601); // input user inclination for MDW1 algorithm
-	beta_ = genBeta(0.01,1000);
+	sample.mag = data.mag.col(i);
 
-	/*************************************************************************
-	 * create results folders
-	 ***********************************************************************/
-	ioDir.create(folderOut + QuatDataResult);
-	ioDir.create(folderOut + EulerDataResult);
+	sample.acc_mdw = sample.acc;
+	sample.mag_mdw = sample.mag;
 
-	/*************************************************************************
-	 * read gyroscope samples as quaternion:
-	 * gyroData_ = {0, gyro_x, gyro_y, gyro_z}
-	 ***********************************************************************/
-	ioData_.setFileName(folderIn + GyroData);
+	//*** Moving average filter ***//
+//	gyro_smooth = gyroData_smooth.col(i);
+//	gyro_smooth *= pi() / 180; // convert gyro readings from deg/s to rad/s
+
+//	acc_smooth = accData_smooth.col(i);
+//	mag_smooth = magData_smooth.col(i);
+
+	//*** Computing equivalent magnetometer vector according to Wilson ***//
+	MagEquivalent(sample.mag, sample.acc);
 
-	ioData_.getValue(numSamples_, "numSamples", "GLOBAL_DATA");
-	gyroData_.zeros(4, numSamples_);
+	//***  Convert to Madgwick dataset representation (when using Madgwick dataset)***//
+	if(DataSource == "MadgwickData"){
 
-	ioData_.getValues(tmpSamples, "gyro_x", "GYRO_DATA", numSamples_);
-	for (unsigned i = 0; i < numSamples_; i++) {
-		gyroData_(1, i) = tmpSamples[i];
+		convertFrame(sample.acc_mdw);
+		convertFrame(sample.mag_mdw);
 	}
-	ioData_.getValues(tmpSamples, "gyro_y", "GYRO_DATA", numSamples_);
-	for (unsigned i = 0; i < numSamples_; i++) {
-		gyroData_(2, i) = tmpSamples[i];//- for mdw dataset
+}
+
+/****************************************************************************
+ * run the lanes from lane up to lastLane (excluded) of the fusion blocks of an
+ * algorithm with a sensor sample, the lanes are the beta values. Nothing but
+ * these lanes are changed, thus any lane group of any algorithm may be run on
+ * a thread of its own.
+ ***************************************************************************/
+void runSample(BatchFusionBlock &fusions, const SensorSample &sample,
+		const size_t lane, const size_t lastLane)
+{
+	if (fusions.getAlgorithm() == BatchFusionBlock::MADGWICK) {
+		/** run with Madgwick original fusion algorithm ***************************/
+		fusions.setSample(sample.gyro, sample.acc_mdw, sample.mag_mdw, lane,
+				lastLane);
 	}
-	ioData_.getValues(tmpSamples, "gyro_z", "GYRO_DATA", numSamples_);
-	for (unsigned i = 0; i < numSamples_; i++) {
-		gyroData_(3, i) = tmpSamples[i];//- for mdw dataset
+	else {
+		/**run with Wilson or QGD fusion algorithm******************************/
+		fusions.setSample(sample.gyro, sample.acc, sample.mag, lane, lastLane);
 	}
+	fusions.run(0.01, lane, lastLane);
+}
 
-	/****************************************************************************
-	 * read accelerometer samples as quaternion:
-	 * accData_ = {0, acc_x, acc_y, acc_z}
-	 ***************************************************************************/
-	ioData_.setFileName(folderIn + AccData);
-	accData_.zeros(4, numSamples_);
+/****************************************************************************
+ * return the results of the fusion blocks of an algorithm of beta value j
+ * with a sensor sample of sample i of data in record, the Euler angles are
+ * left to the analysis unless euler is set. The Madgwick record returns the
+ * true orientation as well.
+ ***************************************************************************/
+void recordSample(const BatchFusionBlock &fusions, const SensorSample &sample,
+		const Dataset &data, const unsigned i, const unsigned j,
+		ResultRecord &record, const bool euler, const unsigned algorithm)
+{
+	Quaternion q_conj, qTrue_conj;
+	arma::Col<double>::fixed<3> angles, anglesT;
+	const Quaternion &qTrue = sample.qTrue;
+
+	//*** collect quaternion results, the true one along with Madgwick ***//
+	double *quat = record.quat + 4 * (algorithm + 1);
+	fusions.getQuaternion(j, quat);
+	if (algorithm == SWEEP_MADGWICK) {
+		record.beta = j;
+		record.sample = data.first + i;
+		record.quat[0] = qTrue.s();
+		record.quat[1] = qTrue.v1();
+		record.quat[2] = qTrue.v2();
+		record.quat[3] = qTrue.v3();
+	}
+	if (!euler) {
+		return;
+	}
 
-	ioData_.getValues(tmpSamples, "acc_x", "ACC_DATA", numSamples_);
-	for (unsigned i = 0; i < numSamples_; i++) {
-		accData_(1, i) = tmpSamples[i];
+	//*** convert quaternions to Euler angles ***//
+	q_conj = fusions.getQuaternion(j);
+	q_conj.to_conj();
+	q_conj.to_EulerAngles(angles);
+	angles *=180/pi();
+	for (unsigned k = 0; k < 3; k++) {
+		record.euler[3 * (algorithm + 1) + k] = angles[k];
 	}
-	ioData_.getValues(tmpSamples, "acc_y", "ACC_DATA", numSamples_);
-	for (unsigned i = 0; i < numSamples_; i++) {
-		accData_(2, i) = tmpSamples[i];
+
+	if (algorithm == SWEEP_MADGWICK) {
+		qTrue_conj = qTrue;
+		qTrue_conj.to_conj();
+		qTrue_conj.to_EulerAngles(anglesT);
+		anglesT *=180/pi();
+		for (unsigned k = 0; k < 3; k++) {
+			record.euler[k] = anglesT[k];
+		}
+	}
+
+//	string filename5 = "./Results/2023_02_synt/dynamic/imu_data_raw.csv";
+//	write_csv_file(filename5,
+//		std::to_string(sample.gyro.v1()).c_str(),
+//		std::to_string(sample.gyro.v2()).c_str(),
+//		std::to_string(sample.gyro.v3()).c_str(),
+//		std::to_string(sample.acc.v1()).c_str(),
+//		std::to_string(sample.acc.v2()).c_str(),
+//		std::to_string(sample.acc.v3()).c_str(),
+//		std::to_string(sample.mag.v1()).c_str(),
+//		std::to_string(sample.mag.v2()).c_str(),
+//		std::to_string(sample.mag.v3()).c_str(),
+//		NULL);
+}
+
+/****************************************************************************
+ * start reading the recording of a configuration file into the dataset cache
+ * on a background thread, a failure is reported by the run of that file
+ ***************************************************************************/
+void prefetchDataset(DatasetCache &_cache, const string &_confFileName)
+{
+	IoConfigFile conf;
+	string GyroData, AccData, MagData, QuatData;
+	try {
+		conf.loadFile(_confFileName, false);
+		conf.getValue(GyroData, "GyroData");
+		conf.getValue(AccData, "AccData");
+		conf.getValue(MagData, "MagData");
+		conf.getValue(QuatData, "QuatData");
+		_cache.prefetch(folderIn + GyroData, folderIn + AccData,
+				folderIn + MagData, folderIn + QuatData);
 	}
-	ioData_.getValues(tmpSamples, "acc_z", "ACC_DATA", numSamples_);
-	for (unsigned i = 0; i < numSamples_; i++) {
-		accData_(3, i) = tmpSamples[i];
+	catch (...) {
+		cerr << "INFO : could not prefetch data of " << _confFileName << endl;
 	}
+}
 
-	/****************************************************************************
-	 * read magnetometer samples as quaternion:
-	 * magData_ = {0, mag_x, mag_y, mag_z}
-	 ***************************************************************************/
-	ioData_.setFileName(folderIn + MagData);
+/****************************************************************************
+ * the outputs and the threads shared by all runs of the beta sweeps
+ ***************************************************************************/
+struct FusionRunContext {
+	/** the result store of the sweep, the CSV files are written if not open */
+	ResultStore *p_resultStore;
+
+	/** the summary file of the sweep, written instead of any results if open */
+	CsvWriter *p_summaryFile;
+
+	/** the writer of the convergence times, none are found if it has no dir */
+	const ConvergenceWriter *p_convergenceWriter;
+
+	/** concurrent runs open their datasets in the result store and write their
+	 * summaries and convergence times in the order of their turns */
+	Turnstile *p_startTurns;
+	Turnstile *p_finishTurns;
+
+	/** decoded recordings shared by all configuration files and repetitions,
+	 * the catalog of the input data directory, the threads reading the gyro,
+	 * acc, mag and quat file of a recording concurrently and the ones
+	 * converting their keys, NULL converts each key on its file's thread */
+	DatasetCache *p_datasetCache;
+	const DatasetCatalog *p_datasetCatalog;
+	ThreadPool *p_loaderPool;
+	ThreadPool *p_parsePool;
+
+	/** the threads the beta values are run on, all on the run's thread if NULL */
+	WorkStealingPool *p_sweepPool;
+};
+
+/****************************************************************************
+ * a run of the beta sweep of a configuration file with everything it
+ * changes: its configuration, the fusion blocks of all beta values and the
+ * sink of its results. The shared outputs of the context (result store,
+ * summary file, convergence files) are written in the order of the turns of
+ * the runs, thus any number of runs may be active on different threads and
+ * the results are the same as if they were done one by one.
+ ***************************************************************************/
+class FusionRun {
 
-	magData_.zeros(4, numSamples_);
+	/** the shared outputs and threads */
+	const FusionRunContext &context_;
 
-	ioData_.getValues(tmpSamples, "mag_x", "MAG_DATA", numSamples_);
-	for (unsigned i = 0; i < numSamples_; i++) {
-		magData_(1, i) = tmpSamples[i];
+	/** the configuration file and the result folders */
+	IoConfigFile conf_;
+	IoDirectory dir_;
+
+	string confFileName_;
+	unsigned long chunkSize_;
+	bool quatOnly_;
+
+	/** the repetition of the configuration file, see getRandomQuaternion */
+	size_t trial_;
+
+	/** the samples of the recording */
+	unsigned long numSamples_ = 0;
+
+	/** the beta values and the fusion blocks of any algorithm, a lane per
+	 * beta value */
+	vector<double> betas_;
+	BatchFusionBlock fusions_[SWEEP_NUM_ALGORITHMS];
+
+	/** the results are written to file on a thread of their own, and the
+	 * dataset of the result store they are written to, if begun */
+	ResultSink sink_;
+	size_t storeDataset_ = 0;
+	bool storeBegun_ = false;
+
+	/****************************************************************************
+	 * hand the results of a block of size samples of all beta values to the
+	 * sink, the results of any beta value in the order of their samples
+	 ***************************************************************************/
+	void pushBlock(const vector<ResultRecord> &block, unsigned &size)
+	{
+		for (unsigned int j = 0; j < betas_.size(); j++) {
+			for (unsigned k = 0; k < size; k++) {
+				sink_.push(block[j * SWEEP_BLOCK_SIZE + k]);
+			}
+		}
+		size = 0;
 	}
-	ioData_.getValues(tmpSamples, "mag_y", "MAG_DATA", numSamples_);
-	for (unsigned i = 0; i < numSamples_; i++) {
-		magData_(2, i) = tmpSamples[i];
+
+public:
+	/****************************************************************************
+	 * repetition _trial of the run of _confFileName with the shared outputs
+	 * and threads of _context
+	 ***************************************************************************/
+	FusionRun(const FusionRunContext &_context, const string &_confFileName,
+			const unsigned long _chunkSize, const bool _quatOnly, const size_t _trial)
+	: context_(_context), confFileName_(_confFileName), chunkSize_(_chunkSize),
+	  quatOnly_(_quatOnly),
+	  trial_(_trial), betas_(getBetas())
+	{
 	}
-	ioData_.getValues(tmpSamples, "mag_z", "MAG_DATA", numSamples_);
-	for (unsigned i = 0; i < numSamples_; i++) {
-		magData_(3, i) = tmpSamples[i];
+
+	/****************************************************************************
+	 * the beta values of any sweep
+	 ***************************************************************************/
+	static vector<double> getBetas()
+	{
+		return genBeta(0.01,1000);
 	}
 
-//	/****************************************************************************
-//	 * read sampling time values
-//	 ***************************************************************************/
-//	ioData_.setFileName("../ExampleData/SensorData/sampling_time_X1.dat");
-//	timeData_.zeros(numSamples_);
-//
-//	ioData_.getValues(tmpSamples, "time", "TIME_DATA", numSamples_);
-//	for (unsigned i = 0; i < numSamples_; i++) {
-//		timeData_(i) = tmpSamples[i];
-//	}
+	/** get random quaternion that represents rotation around a random axis by u
+	 * by a random angle theta, when |theta| < 10 degrees. The random numbers
+	 * are the block of counter (beta value j, trial) of the stream of the
+	 * recording, thus they do not depend on any other run. **/
+	static Quaternion getRandomQuaternion(const Philox &stream, const unsigned j,
+			const size_t trial)
+	{
+	   array<uint32_t, 4> random = stream({j, (uint32_t) trial,
+			   (uint32_t) ((uint64_t) trial >> 32), 0});
+	   arma::Col<double>::fixed<3> u;
+	   for(unsigned int i=0;i<3;i++){
+			   u(i) = Philox::toUniform(random[i]);
+	   }
+	   double theta = Philox::toUniform(random[3])*10; // random angle between -10 and 10 degrees
+	   theta = theta*pi()/180; // convert angle from degrees to radians
+	   Quaternion random_quat = Quaternion(u, theta); // construct quaternion from axis and angle
+	   return random_quat;
+	}
 
 	/****************************************************************************
-	 * read true quaternion:
-	 * quat = {qw,qx,qy,qz}
+	 * run the beta sweep, see sweep. If it fails, the sink is aborted and the
+	 * dataset begun in the result store is dropped, thus the shared outputs
+	 * get nothing of the run.
 	 ***************************************************************************/
-	ioData_.setFileName(folderIn + QuatData);
+	int run(const size_t _turn, const string &_nextConfFileName = "")
+	{
+		try {
+			return sweep(_turn, _nextConfFileName);
+		}
+		catch (...) {
+			sink_.abort();
+			if (storeBegun_) {
+				context_.p_resultStore->abortDataset(storeDataset_);
+				storeBegun_ = false;
+			}
+			throw;
+		}
+	}
+
+private:
+	int sweep(const size_t _turn, const string &_nextConfFileName);
+};
 
-	quatData_.zeros(4, numSamples_);
+/****************************************************************************
+ * run the beta sweep. The recording is read in chunks of chunkSize_ samples
+ * (all at once if 0), any chunk is run through the fusion blocks of all beta
+ * values before the next one is read. The fusion blocks of each beta value
+ * keep their state from chunk to chunk, thus the results do not depend on the
+ * chunk size. Whole recordings are taken from the dataset cache, and the
+ * recording of _nextConfFileName (if any) is prefetched while the sweep runs.
+ * The beta values of an algorithm are the lanes of a BatchFusionBlock, its
+ * lane groups are run as tasks of the sweep pool, if any, in blocks of
+ * SWEEP_BLOCK_SIZE samples. The cost of a task is estimated
+ * by the samples left in the recording, thus the blocks of longer recordings
+ * are run first. Run _turn starts and finishes after run _turn - 1.
+ ***************************************************************************/
+int FusionRun::sweep(const size_t _turn, const string &_nextConfFileName) {
+	string Mode, DataSource, GyroData, AccData, MagData, QuatData,QuatDataResult,EulerDataResult;
+//	const string Mode = argv[1];
+//	const string DataSource = argv[2];
+//	const string i = argv[3];
 
-	ioData_.getValues(tmpSamples, "quat_w", "QUAT_DATA", numSamples_);
-	for (unsigned i = 0; i < numSamples_; i++) {
-		quatData_(0, i) = tmpSamples[i];
+	/** wait for the runs before, see FusionRunContext ***********************/
+	context_.p_startTurns->wait(_turn);
+
+	/** load the configuration file ******************************************/
+	conf_.loadFile(confFileName_, false);
+
+	/** get config data from global section **********************************/
+	conf_.getValue(Mode, "Mode");
+	conf_.getValue(DataSource, "DataSource");
+	conf_.getValue(GyroData, "GyroData");
+	conf_.getValue(AccData, "AccData");
+	conf_.getValue(MagData, "MagData");
+	conf_.getValue(QuatData, "QuatData");
+	conf_.getValue(QuatDataResult, "QuatDataResult");
+	conf_.getValue(EulerDataResult, "EulerDataResult");
+
+	/** the rows written of any beta value, all unless decimated, a window
+	 * without decimation keeps the rows of the window only ******************/
+	unsigned long every = 1;
+	valarray<double> window = {1, 0};
+	bool envelope = false;
+	if (conf_.keyExists("OutputWindow", "")) {
+		conf_.getValues(window, "OutputWindow", "", 2);
+		every = 0;
 	}
-	ioData_.getValues(tmpSamples, "quat_x", "QUAT_DATA", numSamples_);
-	for (unsigned i = 0; i < numSamples_; i++) {
-		quatData_(1, i) = tmpSamples[i];
+	if (conf_.keyExists("OutputDecimation", "")) {
+		conf_.getValue(every, "OutputDecimation");
 	}
-	ioData_.getValues(tmpSamples, "quat_y", "QUAT_DATA", numSamples_);
-	for (unsigned i = 0; i < numSamples_; i++) {
-		quatData_(2, i) = tmpSamples[i];
+	if (conf_.keyExists("OutputEnvelope", "")) {
+		conf_.getValue(envelope, "OutputEnvelope");
 	}
-	ioData_.getValues(tmpSamples, "quat_z", "QUAT_DATA", numSamples_);
-	for (unsigned i = 0; i < numSamples_; i++) {
-		quatData_(3, i) = tmpSamples[i];
+	OutputDecimation decimation(every, window[0], window[1], envelope);
+
+	/*************************************************************************
+	 * create results folders
+	 ***********************************************************************/
+	ResultStore &resultStore = *context_.p_resultStore;
+	bool summary = context_.p_summaryFile->isOpen();
+	if (!resultStore.isOpen() && !summary) {
+		dir_.create(folderOut + QuatDataResult);
+		if (!quatOnly_) {
+			dir_.create(folderOut + EulerDataResult);
+		}
+	}
+
+	/*************************************************************************
+	 * open gyroscope, accelerometer, magnetometer and true quaternion files
+	 ***********************************************************************/
+	DatasetReader reader(folderIn + GyroData, folderIn + AccData,
+			folderIn + MagData, folderIn + QuatData);
+	reader.setThreadPool(context_.p_loaderPool);
+	reader.setParsePool(context_.p_parsePool);
+	reader.setCatalog(context_.p_datasetCatalog);
+	reader.check();
+	unsigned long numSamples = reader.getNumSamples();
+	numSamples_ = numSamples;
+
+	/** the first chunk has to include sample 1 for initialization ***********/
+	unsigned long chunkSize = numSamples;
+	if (chunkSize_ > 0 && chunkSize_ < numSamples) {
+		chunkSize = std::max<unsigned long>(chunkSize_, 2);
 	}
 
 //	deleteDirectoryContents(folderOut + "euler/");
 //	deleteDirectoryContents(folderOut + "quat/");
 
-//	gyroData_smooth = gyroData_;
-//	accData_smooth = accData_;
-//	magData_smooth = magData_;
+	vector<Quaternion> randomQuats;
+	vector<string> quatFileNames, eulerFileNames;
+	for (unsigned a = 0; a < SWEEP_NUM_ALGORITHMS; a++) {
+		fusions_[a] = BatchFusionBlock((BatchFusionBlock::Algorithm) a, betas_,
+				SWEEP_MAG_REF);
+	}
 
-//	movingAvg(gyroData_smooth, 10);
-//	movingAvg(accData_smooth, 30);
-//	movingAvg(magData_smooth, 50);
+	shared_ptr<const Dataset> cachedData;
+	Dataset chunk;
+	const Dataset *p_data;
+
+	const bool euler = (!quatOnly_ && !summary)
+			|| context_.p_convergenceWriter->getDirName() != "";
+
+	/** draw the initial quaternions and name the files of all beta values.
+	 * The stream is keyed by the data files of the recording, thus it does
+	 * not change with the name of the configuration file, and the runs of
+	 * any configuration files of the same recording start alike *************/
+	string dataset = filesystem::path(confFileName_).stem().string();
+	Philox stream(GyroData + '\n' + AccData + '\n' + MagData + '\n' + QuatData);
+	for (unsigned int j = 0; j < betas_.size(); j++){
+
+		randomQuats.push_back(getRandomQuaternion(stream, j, trial_));
+
+		//*** create file index ***//
+		string beta_str = "/";
+		if(j<10) beta_str += "000";
+		else if(j<100) beta_str += "00";
+		else if(j<1000) beta_str += "0";
+		beta_str += std::to_string(j) + ".csv";
+
+		quatFileNames.push_back(folderOut + QuatDataResult + beta_str);
+		if (!quatOnly_) {
+			eulerFileNames.push_back(folderOut + EulerDataResult + beta_str);
+		}
+	}
+	if (context_.p_convergenceWriter->getDirName() != "") {
+		sink_.setConvergence(context_.p_convergenceWriter, EulerDataResult.substr(
+				EulerDataResult.size() - std::min<size_t>(4, EulerDataResult.size())));
+	}
+	sink_.setDecimation(decimation);
+	if (summary) {
+		sink_.open(*context_.p_summaryFile, dataset, betas_);
+	}
+	else if (resultStore.isOpen()) {
+		storeDataset_ = resultStore.beginDataset(dataset, betas_, 1,
+				decimation.getNumRows(numSamples - 1));
+		storeBegun_ = true;
+		sink_.open(resultStore, storeDataset_, betas_);
+	}
+	else {
+		sink_.open(quatFileNames, eulerFileNames, betas_);
+	}
+	context_.p_startTurns->pass(_turn);
+
+	/** the results of two blocks of samples of all beta values, one of them
+	 * is handed to the sink while the other one is run **********************/
+	vector<ResultRecord> blocks[2];
+	unsigned blockSizes[2] = {0, 0};
+	unsigned current = 0;
+	blocks[0].resize(betas_.size() * SWEEP_BLOCK_SIZE);
+	blocks[1].resize(betas_.size() * SWEEP_BLOCK_SIZE);
+
+	/** the sensor samples of the block run, shared by all beta values *******/
+	vector<SensorSample> samples(SWEEP_BLOCK_SIZE);
+
+	for (unsigned long first = 0; first < numSamples; first += chunkSize) {
+
+		/** get the whole recording or read the next chunk of samples *********/
+		if (chunkSize == numSamples) {
+			cachedData = context_.p_datasetCache->get(folderIn + GyroData, folderIn + AccData,
+					folderIn + MagData, folderIn + QuatData);
+			p_data = cachedData.get();
+			if (_nextConfFileName != "") {
+				prefetchDataset(*context_.p_datasetCache, _nextConfFileName);
+			}
+		}
+		else {
+			reader.read(chunk, first, chunkSize);
+			p_data = &chunk;
+		}
+		const Dataset &data = *p_data;
+
+		/** initialize the fusion blocks of all beta values once *************/
+		if (first == 0) {
+			for (unsigned int j = 0; j < betas_.size(); j++){
+
+//				Quaternion qOldM1_ = Quaternion(  0.264, -0.061, 0.106, -0.957 );
+//				Quaternion qOldW_ = Quaternion(  0.264, -0.061, 0.106, -0.957 );
+//				Quaternion qOldQ_ = Quaternion(  0.264, -0.061, 0.106, -0.957 );
+
+//				Initialize fusions with quaternion close to true
+				Quaternion qTrue, q_relative;
+				qTrue = data.quat.col(1);
+				q_relative = randomQuats[j];
+				q_relative *= qTrue;
+				q_relative.to_normalized();
+				for (BatchFusionBlock &fusions : fusions_) {
+					fusions.setQuaternion(j, q_relative);
+				}
+			}
+		}
 
-	for (unsigned int j = 0; j < beta_.size(); j++){
+		/**Start loop to execute the fusion algorithms**/
+		for (unsigned begin = (first == 0) ? 1 : 0; begin < data.size;
+				begin += SWEEP_BLOCK_SIZE) {
+			unsigned size = std::min<unsigned>(SWEEP_BLOCK_SIZE, data.size - begin);
+			vector<ResultRecord> &block = blocks[current];
+			vector<future<void>> futures;
+			double remaining = numSamples - (first + begin);
+			for (unsigned k = 0; k < size; k++) {
+				prepareSample(data, begin + k, DataSource, samples[k]);
+			}
+			for (size_t lane = 0; lane < betas_.size();
+					lane += BatchFusionBlock::LANE_GROUP) {
+				size_t lastLane = std::min(lane + BatchFusionBlock::LANE_GROUP,
+						betas_.size());
+				for (unsigned a = 0; a < SWEEP_NUM_ALGORITHMS; a++) {
+					function<void()> runBlock = [&, lane, lastLane, a, begin, size]() {
+						for (unsigned k = 0; k < size; k++) {
+							runSample(fusions_[a], samples[k], lane, lastLane);
+							for (size_t j = lane; j < lastLane; j++) {
+								recordSample(fusions_[a], samples[k], data, begin + k, j,
+										block[j * SWEEP_BLOCK_SIZE + k], euler, a);
+							}
+						}
+					};
+					if (context_.p_sweepPool != NULL) {
+						futures.push_back(context_.p_sweepPool->submit(runBlock,
+								SWEEP_ALGORITHM_COST[a] * remaining * (lastLane - lane)));
+					}
+					else {
+						runBlock();
+					}
+				}
+			}
 
-		WilsonFusionBlock wilson_(beta_[j]); // Wilson
-		Madgwick1FusionBlock mdw1_(beta_[j], magRef_); // Madgwick original
-		QuaternionGradientDescentBlock qgd_(beta_[j]); // QGD
+			/** hand the previous block to the sink while this one is run. All
+			 * tasks are waited for before any error is rethrown, as they refer
+			 * to the block, the samples and the fusion blocks ******************/
+			exception_ptr error;
+			try {
+				pushBlock(blocks[1 - current], blockSizes[1 - current]);
+			}
+			catch (...) {
+				error = current_exception();
+			}
+			for (future<void> &result : futures) {
+				try {
+					result.get();
+				}
+				catch (...) {
+					if (!error) {
+						error = current_exception();
+					}
+				}
+			}
+			if (error) {
+				rethrow_exception(error);
+			}
+			blockSizes[current] = size;
+			current = 1 - current;
+		}
+	}
+	pushBlock(blocks[1 - current], blockSizes[1 - current]);
+
+	/** the summary and the convergence times are written on closing ********/
+	context_.p_finishTurns->wait(_turn);
+	sink_.close();
+	if (storeBegun_) {
+		resultStore.endDataset(storeDataset_);
+		storeBegun_ = false;
+	}
+	std::cout << "Finished in mode " << Mode << " on data " << DataSource << std::endl;
+	context_.p_finishTurns->pass(_turn);
+    return 0;
+}
 
-//		Quaternion qOldM1_ = Quaternion(  0.264, -0.061, 0.106, -0.957 );
-//		Quaternion qOldW_ = Quaternion(  0.264, -0.061, 0.106, -0.957 );
-//		Quaternion qOldQ_ = Quaternion(  0.264, -0.061, 0.106, -0.957 );
+/****************************************************************************
+ * check the batched fusion algorithms against the scalar ones on the beta
+ * values of a sweep, true if all lanes of all algorithms agree
+ ***************************************************************************/
+bool checkBatchFusion()
+{
+	const char *algorithms[SWEEP_NUM_ALGORITHMS] = {"Madgwick", "Wilson", "QGD"};
+	BatchFusionCheck check(SWEEP_MAG_REF);
+	bool agree = true;
+	for (unsigned a = 0; a < SWEEP_NUM_ALGORITHMS; a++) {
+		double difference = check.run((BatchFusionBlock::Algorithm) a,
+				FusionRun::getBetas(), CHECK_NUM_SAMPLES);
+		cout << "INFO : " << algorithms[a] << " batched and scalar differ by "
+				<< difference << endl;
+		if (difference > CHECK_TOLERANCE) {
+			cerr << "ERROR : checkBatchFusion : " << algorithms[a]
+					<< " batched differs from scalar" << endl;
+			agree = false;
+		}
+	}
+	return agree;
+}
+
+/****************************************************************************
+ * run the configuration files of a batch, each one as often as repeated, on
+ * the sweep pool: several runs are in flight at a time, each one handing the
+ * blocks of its beta values to the pool, thus the pool is kept busy even if
+ * a single sweep has less beta values than threads. The results are the
+ * same as if the files were run one by one.
+ ***************************************************************************/
+void runBatch(SenseOptions &senseOptions, const FusionRunContext &context)
+{
+	vector<string> confFileNames;
+	for (size_t i = 0; i < senseOptions.getNumBatchFiles(); i++) {
+		for (size_t j = 0; j < senseOptions.getNumRepetitions(); j++) {
+			confFileNames.push_back(senseOptions.getBatchFileName(i));
+		}
+	}
 
-//		Initialize fusions with quaternion close to true
-		qTrue_ = quatData_.col(1);
-		q_relative_ = getRandomQuaternion();
-		q_relative_ *= qTrue_;
-		q_relative_.to_normalized();
-		Quaternion qOldM1_ = q_relative_;
-		Quaternion qOldW_ = q_relative_;
-		Quaternion qOldQ_ = q_relative_;
+	/** as many runs in flight as needed to give any thread a beta value *****/
+	size_t numThreads = (context.p_sweepPool != NULL)
+			? context.p_sweepPool->getNumThreads() : 1;
+	size_t numRuns = std::min(confFileNames.size(),
+			numThreads / std::max<size_t>(FusionRun::getBetas().size(), 1) + 2);
+
+	atomic<size_t> next(0);
+	vector<exception_ptr> errors(numRuns);
+	vector<thread> runners;
+	for (size_t r = 0; r < numRuns; r++) {
+		runners.emplace_back([&, r]() {
+			for (size_t turn = next++; turn < confFileNames.size(); turn = next++) {
+				try {
+					FusionRun run(context, confFileNames[turn],
+							senseOptions.getChunkSize(), senseOptions.getQuatOnly(),
+							turn % senseOptions.getNumRepetitions());
+					run.run(turn);
+				}
+				catch (...) {
+					/** let the runs after this one go on, but only once the runs
+					 * before it are through, as passing a turn passes all turns
+					 * before it. The first error is rethrown once all runs are
+					 * done ***********************************************************/
+					context.p_startTurns->wait(turn);
+					context.p_startTurns->pass(turn);
+					context.p_finishTurns->wait(turn);
+					context.p_finishTurns->pass(turn);
+					if (!errors[r]) {
+						errors[r] = current_exception();
+					}
+				}
+			}
+		});
+	}
+	for (thread &runner : runners) {
+		runner.join();
+	}
+	for (exception_ptr &error : errors) {
+		if (error) {
+			rethrow_exception(error);
+		}
+	}
+}
 
-		buffer.clear();
+int main(int argc, char *argv[]) {
 
-		/**Start loop to execute the fusion algorithms**/
-		for (unsigned i = 1; i < numSamples_; i++) {
-			qTrue_ = quatData_.col(i);
-			/** get samples from sensors ******************************************/
-			gyro_ = gyroData_.col(i);
-			gyro_ *= pi() / 180; // convert gyro readings from deg/s to rad/s
-//			acc_ = accData_.col(i);
+	SenseOptions senseOptions(argc, argv);
+
+	/** reads the gyro, acc, mag and quat file of a recording concurrently **/
+	ThreadPool loaderPool(4);
 
-			//*** get true acc measurement from true quaternion ***//
-			acc_ = Quaternion(0,0,0,-1);
-			qTrue_conj = qTrue_;
-			qTrue_conj.to_conj();
-			acc_ *= qTrue_;
-			qTrue_conj *= acc_;
-			acc_ = qTrue_conj;
+	/** converts the keys of the text data files on as many threads as the
+	 * beta values are run on, a single one converts each key on the thread
+	 * reading its file ******************************************************/
+	unique_ptr<ThreadPool> parsePool;
+	if (senseOptions.getNumThreads() != 1) {
+		parsePool.reset(new ThreadPool(senseOptions.getNumThreads()));
+	}
 
-			mag_ = magData_.col(i);
+	/** decoded recordings shared by all configuration files and repetitions */
+	DatasetCache datasetCache(8);
+	datasetCache.setThreadPool(&loaderPool);
+	datasetCache.setParsePool(parsePool.get());
 
-			acc_mdw = acc_;
-			mag_mdw = mag_;
+	/** the catalog of the input data directory, empty if there is none *****/
+	DatasetCatalog datasetCatalog;
 
-			//*** Moving average filter ***//
-//			gyro_smooth = gyroData_smooth.col(i);
-//			gyro_smooth *= pi() / 180; // convert gyro readings from deg/s to rad/s
+	/** catalog data directories only ****************************************/
+	if (senseOptions.getNumCatalogDirs() > 0) {
+		for (size_t i = 0; i < senseOptions.getNumCatalogDirs(); i++) {
+			datasetCatalog.scan(senseOptions.getCatalogDirName(i));
+			std::cout << "Cataloged " << senseOptions.getCatalogDirName(i)
+					<< std::endl;
+		}
+		return 0;
+	}
+	/** average convergence directories and summary files only ****************/
+	if (senseOptions.getNumAggregateNames() > 0) {
+		ThreadPool pool;
+		Aggregation aggregation(pool);
+		for (size_t i = 0; i < senseOptions.getNumAggregateNames(); i++) {
+			if (std::filesystem::is_directory(senseOptions.getAggregateName(i))) {
+				aggregation.averageConvergenceDirs(senseOptions.getAggregateName(i));
+			} else {
+				aggregation.averageSummary(senseOptions.getAggregateName(i));
+			}
+		}
+		return 0;
+	}
 
-//			acc_smooth = accData_smooth.col(i);
-//			mag_smooth = magData_smooth.col(i);
+	/** check the batched fusion algorithms only ******************************/
+	if (senseOptions.getCheckBatch()) {
+		return checkBatchFusion() ? 0 : 1;
+	}
 
-			//*** Computing equivalent magnetometer vector according to Wilson ***//
-			MagEquivalent();
+	datasetCatalog.load(folderIn);
+	datasetCache.setCatalog(&datasetCatalog);
 
-			//***  Convert to Madgwick dataset representation (when using Madgwick dataset)***//
-			if(DataSource == "MadgwickData"){
+	/** convert data files to binary data files only *************************/
+	if (senseOptions.getNumConvertFiles() > 0) {
+		for (size_t i = 0; i < senseOptions.getNumConvertFiles(); i++) {
+			convertDataFile(senseOptions.getConvertFileName(i),
+					senseOptions.getCompressData());
+		}
+		return 0;
+	}
 
-				convertFrame(acc_mdw);
-				convertFrame(mag_mdw);
-			}
+	/** run the beta values of any sweep on several threads ******************/
+	unique_ptr<WorkStealingPool> sweepPool;
+	if (senseOptions.getNumThreads() != 1 || senseOptions.getNumBatchFiles() > 0) {
+		sweepPool.reset(new WorkStealingPool(senseOptions.getNumThreads()));
+	}
 
-			/** run with Madgwick original fusion algorithm *****************************/
-			qM1_ = mdw1_.run(gyro_, acc_mdw, mag_mdw, 0.01, qOldM1_);
-			qOldM1_ = qM1_;
-
-			/**run with Wilson fusion algorithm************************************/
-			qW_ = wilson_.run(gyro_, acc_, mag_, 0.01, qOldW_);
-			qOldW_ = qW_;
-
-			/** run with QGD fusion algorithm *****************************/
-			qQ_ = qgd_.run(gyro_, acc_, mag_, 0.01, qOldQ_);
-			qOldQ_ = qQ_;
-
-
-			//*** create file index ***//
-			string beta_str = "/";
-			if(j<10) beta_str += "000";
-			else if(j<100) beta_str += "00";
-			else if(j<1000) beta_str += "0";
-			beta_str += std::to_string(j) + ".csv";
-
-			//*** write quaternion results to file ***//
-			string filename = folderOut + QuatDataResult + beta_str;
-			write_csv_file(filename,
-					std::to_string(qTrue_.s()).c_str(),
-					std::to_string(qTrue_.v1()).c_str(),
-					std::to_string(qTrue_.v2()).c_str(),
-					std::to_string(qTrue_.v3()).c_str(),
-					std::to_string(qM1_.s()).c_str(),
-					std::to_string(qM1_.v1()).c_str(),
-					std::to_string(qM1_.v2()).c_str(),
-					std::to_string(qM1_.v3()).c_str(),
-					std::to_string(qW_.s()).c_str(),
-					std::to_string(qW_.v1()).c_str(),
-					std::to_string(qW_.v2()).c_str(),
-					std::to_string(qW_.v3()).c_str(),
-					std::to_string(qQ_.s()).c_str(),
-					std::to_string(qQ_.v1()).c_str(),
-					std::to_string(qQ_.v2()).c_str(),
-					std::to_string(qQ_.v3()).c_str(),
-					std::to_string(beta_[j]).c_str(),
-					NULL);
-
-			//*** convert quaternions to Euler angles ***//
-			qTrue_conj = qTrue_;
-			qTrue_conj.to_conj();
-			qTrue_conj.to_EulerAngles(anglesT_);
-			anglesT_ *=180/pi();
-
-			q_mdw1_conj = qM1_;
-			q_mdw1_conj.to_conj();
-			q_mdw1_conj.to_EulerAngles(anglesM1_);
-			anglesM1_ *=180/pi();
-
-			qWilson_conj = qW_;
-			qWilson_conj.to_conj();
-			qWilson_conj.to_EulerAngles(anglesW_);
-			anglesW_ *=180/pi();
-
-			qQGD_conj = qQ_;
-			qQGD_conj.to_conj();
-			qQGD_conj.to_EulerAngles(anglesQ_);
-			anglesQ_ *=180/pi();
-
-			//*** write Euler angle results to file ***//
-			string filename1 = folderOut + EulerDataResult + beta_str;
-			write_csv_file(filename1,
-				std::to_string(anglesT_[0]).c_str(),// -
-				std::to_string(anglesT_[1]).c_str(),// -
-				std::to_string(anglesT_[2]).c_str(),
-				std::to_string(anglesM1_[0]).c_str(),
-				std::to_string(anglesM1_[1]).c_str(),
-				std::to_string(anglesM1_[2]).c_str(),
-				std::to_string(anglesW_[0]).c_str(),
-				std::to_string(anglesW_[1]).c_str(),
-				std::to_string(anglesW_[2]).c_str(),
-				std::to_string(anglesQ_[0]).c_str(),
-				std::to_string(anglesQ_[1]).c_str(),
-				std::to_string(anglesQ_[2]).c_str(),
-				std::to_string(beta_[j]).c_str(),
-				NULL);
-
-//			string filename5 = "./Results/2023_02_synt/dynamic/imu_data_raw.csv";
-//			write_csv_file(filename5,
-//				std::to_string(gyro_.v1()).c_str(),
-//				std::to_string(gyro_.v2()).c_str(),
-//				std::to_string(gyro_.v3()).c_str(),
-//				std::to_string(acc_.v1()).c_str(),
-//				std::to_string(acc_.v2()).c_str(),
-//				std::to_string(acc_.v3()).c_str(),
-//				std::to_string(mag_.v1()).c_str(),
-//				std::to_string(mag_.v2()).c_str(),
-//				std::to_string(mag_.v3()).c_str(),
-//				NULL);
+	/** the outputs shared by all runs, see FusionRunContext *****************/
+	ResultStore resultStore;
+	CsvWriter summaryFile;
+	ConvergenceWriter convergenceWriter;
+	Turnstile startTurns, finishTurns;
+	FusionRunContext context = {&resultStore, &summaryFile, &convergenceWriter,
+			&startTurns, &finishTurns, &datasetCache, &datasetCatalog, &loaderPool,
+			parsePool.get(), sweepPool.get()};
+
+	/** write the results of all runs to a single result store ***************/
+	if (senseOptions.getResultStoreName() != "") {
+		resultStore.open(senseOptions.getResultStoreName(),
+				!senseOptions.getQuatOnly());
+	}
 
+	/** write a row of error statistics per dataset, beta and algorithm only */
+	if (senseOptions.getSummaryName() != "") {
+		bool newFile = !filesystem::exists(senseOptions.getSummaryName());
+		summaryFile.open(senseOptions.getSummaryName());
+		if (newFile) {
+			for (const char *field : {"dataset", "algorithm", "betaIndex", "beta",
+					"numSamples", "meanError", "rmsError", "maxError", "finalError",
+					"rmseRoll", "rmsePitch", "rmseYaw"}) {
+				summaryFile.writeField(field);
+			}
+			summaryFile.writeRow({});
 		}
 	}
-	std::cout << "Finished in mode " << Mode << " on data " << DataSource << std::endl;
-    return 0;
-}
 
-int main(int argc, char *argv[]) {
+	/** find the convergence times of euler_analysis.py on the way ***********/
+	if (senseOptions.getConvergence()) {
+		convergenceWriter.setDirName(folderOut + "convergence");
+	}
+
+	/** run the configuration files of a batch concurrently ******************/
+	if (senseOptions.getNumBatchFiles() > 0) {
+		runBatch(senseOptions, context);
+		resultStore.close();
+		summaryFile.close();
+		return 0;
+	}
 
-	SenseOptions senseOptions(argc, argv);
 	/** run a simulation for any configuration file found ********************/
+	size_t turn = 0;
 	for (size_t i = 0; i < senseOptions.getNumConfFiles(); i++) {
 
 		/** repetitions with the same config file ******************************/
 		for (size_t j = 0; j < senseOptions.getNumRepetitions(); j++) {
 
 			/** create the controller for the current run ************************/
-			runFusions(senseOptions.getConfFileName(i));
+			FusionRun run(context, senseOptions.getConfFileName(i),
+					senseOptions.getChunkSize(), senseOptions.getQuatOnly(), j);
+			run.run(turn++, (i + 1 < senseOptions.getNumConfFiles())
+					? senseOptions.getConfFileName(i + 1) : "");
 
 		} /** for (j = 0; j < senseOptions.getNumRepetitions(); j++) ***********/
 
 	} /** for (i = 0; i < senseOptions.getNumConfFiles(); i++) ***************/
+
+	resultStore.close();
+	summaryFile.close();
 }
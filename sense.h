@@ -20,9 +20,11 @@
 #include "io/iooption.h"
 
 #include <cstdlib>
+#include <glob.h>
 #include <iostream>
 #include <string>
 #include <valarray>
+#include <vector>
 
 
 /**#############################################################################
@@ -49,6 +51,30 @@ const string OPTION_NAME_CONF_FILE = "config-file";
 const string OPTION_SHORTCUT_CONF_FILE = "c";
 const string OPTION_REPETITIONS = "repetitions";
 const string OPTION_SHORTCUT_REPETITIONS = "r";
+const string OPTION_CONVERT_DATA = "convert-data";
+const string OPTION_SHORTCUT_CONVERT_DATA = "b";
+const string OPTION_COMPRESS_DATA = "compress-data";
+const string OPTION_SHORTCUT_COMPRESS_DATA = "z";
+const string OPTION_CATALOG = "catalog";
+const string OPTION_SHORTCUT_CATALOG = "g";
+const string OPTION_CHUNK_SIZE = "chunk-size";
+const string OPTION_SHORTCUT_CHUNK_SIZE = "k";
+const string OPTION_RESULT_STORE = "result-store";
+const string OPTION_SHORTCUT_RESULT_STORE = "s";
+const string OPTION_QUAT_ONLY = "quat-only";
+const string OPTION_SHORTCUT_QUAT_ONLY = "q";
+const string OPTION_SUMMARY = "summary";
+const string OPTION_SHORTCUT_SUMMARY = "m";
+const string OPTION_CONVERGENCE = "convergence";
+const string OPTION_SHORTCUT_CONVERGENCE = "v";
+const string OPTION_AGGREGATE = "aggregate";
+const string OPTION_SHORTCUT_AGGREGATE = "a";
+const string OPTION_THREADS = "threads";
+const string OPTION_SHORTCUT_THREADS = "t";
+const string OPTION_BATCH = "batch";
+const string OPTION_SHORTCUT_BATCH = "j";
+const string OPTION_CHECK_BATCH = "check-batch";
+const string OPTION_SHORTCUT_CHECK_BATCH = "e";
 
 
 /**#############################################################################
@@ -88,9 +114,61 @@ class SenseOptions {
 	/**   *******************************/
 	size_t repetitions;
 
+	/**   *******************************/
+	valarray<string> convertFileNames;
+
+	/**   *******************************/
+	bool compressData;
+
+	/**   *******************************/
+	valarray<string> catalogDirNames;
+
+	/**   *******************************/
+	unsigned long chunkSize;
+
+	/**   *******************************/
+	string resultStoreName;
+
+	/**   *******************************/
+	bool quatOnly;
+
+	/**   *******************************/
+	string summaryName;
+
+	/**   *******************************/
+	bool convergence;
+
+	/**   *******************************/
+	valarray<string> aggregateNames;
+
+	/**   *******************************/
+	unsigned numThreads;
+
+	/**   *******************************/
+	valarray<string> batchFileNames;
+
+	/**   *******************************/
+	bool checkBatch;
+
 	/**   *******************************/
 	string optionString;
 
+	/*****************************************************************************
+	 * append the files matching a wildcard pattern, sorted by name, or the
+	 * pattern itself if no file matches
+	 ****************************************************************************/
+	static void expandPattern(const string &_pattern, vector<string> &_names) {
+		glob_t result;
+		if (glob(_pattern.c_str(), 0, NULL, &result) == 0) {
+			for (size_t i = 0; i < result.gl_pathc; i++) {
+				_names.push_back(result.gl_pathv[i]);
+			}
+			globfree(&result);
+		} else {
+			_names.push_back(_pattern);
+		}
+	}
+
 public:
 	/*****************************************************************************
 	 ****************************************************************************/
@@ -98,6 +176,18 @@ public:
 		/** add the options supported *********************************************/
 		optionList.addOption(OPTION_NAME_CONF_FILE, OPTION_SHORTCUT_CONF_FILE, 99);
 		optionList.addOption(OPTION_REPETITIONS, OPTION_SHORTCUT_REPETITIONS, 1);
+		optionList.addOption(OPTION_CONVERT_DATA, OPTION_SHORTCUT_CONVERT_DATA, 99);
+		optionList.addOption(OPTION_COMPRESS_DATA, OPTION_SHORTCUT_COMPRESS_DATA, 0);
+		optionList.addOption(OPTION_CATALOG, OPTION_SHORTCUT_CATALOG, 99);
+		optionList.addOption(OPTION_CHUNK_SIZE, OPTION_SHORTCUT_CHUNK_SIZE, 1);
+		optionList.addOption(OPTION_RESULT_STORE, OPTION_SHORTCUT_RESULT_STORE, 1);
+		optionList.addOption(OPTION_QUAT_ONLY, OPTION_SHORTCUT_QUAT_ONLY, 0);
+		optionList.addOption(OPTION_SUMMARY, OPTION_SHORTCUT_SUMMARY, 1);
+		optionList.addOption(OPTION_CONVERGENCE, OPTION_SHORTCUT_CONVERGENCE, 0);
+		optionList.addOption(OPTION_AGGREGATE, OPTION_SHORTCUT_AGGREGATE, 99);
+		optionList.addOption(OPTION_THREADS, OPTION_SHORTCUT_THREADS, 1);
+		optionList.addOption(OPTION_BATCH, OPTION_SHORTCUT_BATCH, 99);
+		optionList.addOption(OPTION_CHECK_BATCH, OPTION_SHORTCUT_CHECK_BATCH, 0);
 
 		/** extract the options from the command line *****************************/
 		optionList.extractOptions(argc, argv);
@@ -114,6 +204,73 @@ public:
 			repetitions = 1;
 		}
 
+		/** get the data files to be converted to binary data files ***************/
+		if (!optionList.getParams(convertFileNames, OPTION_CONVERT_DATA)) {
+			convertFileNames.resize(0);
+		}
+
+		/** compress the converted binary data files ******************************/
+		valarray<string> noParams;
+		compressData = optionList.getParams(noParams, OPTION_COMPRESS_DATA);
+
+		/** get the data directories to be cataloged *****************************/
+		if (!optionList.getParams(catalogDirNames, OPTION_CATALOG)) {
+			catalogDirNames.resize(0);
+		}
+
+		/** the number of samples read at once, 0 reads the whole recording ******/
+		if (optionList.getParam(optionString, OPTION_CHUNK_SIZE)) {
+			convert.toValue(chunkSize, optionString);
+		} else {
+			chunkSize = 0;
+		}
+
+		/** the result store written instead of the CSV result files ************/
+		if (!optionList.getParam(resultStoreName, OPTION_RESULT_STORE)) {
+			resultStoreName = "";
+		}
+
+		/** write the quaternions only, the Euler angles are derived on reading **/
+		quatOnly = optionList.getParams(noParams, OPTION_QUAT_ONLY);
+
+		/** the summary file written instead of the results of any sample ********/
+		if (!optionList.getParam(summaryName, OPTION_SUMMARY)) {
+			summaryName = "";
+		}
+
+		/** analyze the convergence of the Euler angles while running ************/
+		convergence = optionList.getParams(noParams, OPTION_CONVERGENCE);
+
+		/** the convergence directories and summary files to be averaged *********/
+		if (!optionList.getParams(aggregateNames, OPTION_AGGREGATE)) {
+			aggregateNames.resize(0);
+		}
+
+		/** compare the batched fusion algorithms with the scalar ones only *****/
+		checkBatch = optionList.getParams(noParams, OPTION_CHECK_BATCH);
+
+		/** the configuration files run concurrently, given by name or by a
+		 * wildcard pattern with * and ? (quoted on the command line) **********/
+		valarray<string> batchPatterns;
+		if (optionList.getParams(batchPatterns, OPTION_BATCH)) {
+			vector<string> names;
+			for (size_t i = 0; i < batchPatterns.size(); i++) {
+				expandPattern(batchPatterns[i], names);
+			}
+			batchFileNames.resize(names.size());
+			for (size_t i = 0; i < names.size(); i++) {
+				batchFileNames[i] = names[i];
+			}
+		}
+
+		/** the threads the beta values are run on and the keys of the text data
+		 * files are converted on, 0 uses all hardware threads, as does a batch
+		 * by default ************************************************************/
+		if (optionList.getParam(optionString, OPTION_THREADS)) {
+			convert.toValue(numThreads, optionString);
+		} else {
+			numThreads = (batchFileNames.size() > 0) ? 0 : 1;
+		}
 	}
 
 	/*****************************************************************************
@@ -139,6 +296,102 @@ public:
 		return (confFileNames[_num]);
 	}
 
+	/*****************************************************************************
+	 ****************************************************************************/
+	unsigned long getChunkSize() {
+		return (chunkSize);
+	}
+
+	/*****************************************************************************
+	 ****************************************************************************/
+	string getResultStoreName() {
+		return (resultStoreName);
+	}
+
+	/*****************************************************************************
+	 ****************************************************************************/
+	bool getQuatOnly() {
+		return (quatOnly);
+	}
+
+	/*****************************************************************************
+	 ****************************************************************************/
+	string getSummaryName() {
+		return (summaryName);
+	}
+
+	/*****************************************************************************
+	 ****************************************************************************/
+	bool getConvergence() {
+		return (convergence);
+	}
+
+	/*****************************************************************************
+	 ****************************************************************************/
+	size_t getNumAggregateNames() {
+		return ((size_t) aggregateNames.size());
+	}
+
+	/*****************************************************************************
+	 ****************************************************************************/
+	string getAggregateName(size_t _num) {
+		return (aggregateNames[_num]);
+	}
+
+	/*****************************************************************************
+	 ****************************************************************************/
+	unsigned getNumThreads() {
+		return (numThreads);
+	}
+
+	/*****************************************************************************
+	 ****************************************************************************/
+	bool getCheckBatch() {
+		return (checkBatch);
+	}
+
+	/*****************************************************************************
+	 ****************************************************************************/
+	size_t getNumBatchFiles() {
+		return ((size_t) batchFileNames.size());
+	}
+
+	/*****************************************************************************
+	 ****************************************************************************/
+	string getBatchFileName(size_t _num) {
+		return (batchFileNames[_num]);
+	}
+
+	/*****************************************************************************
+	 ****************************************************************************/
+	size_t getNumConvertFiles() {
+		return ((size_t) convertFileNames.size());
+	}
+
+	/*****************************************************************************
+	 ****************************************************************************/
+	string getConvertFileName(size_t _num) {
+		return (convertFileNames[_num]);
+	}
+
+	/*****************************************************************************
+	 ****************************************************************************/
+	size_t getNumCatalogDirs() {
+		return ((size_t) catalogDirNames.size());
+	}
+
+	/*****************************************************************************
+	 ****************************************************************************/
+	string getCatalogDirName(size_t _num) {
+		return (catalogDirNames[_num]);
+	}
+
+	/*****************************************************************************
+	 ****************************************************************************/
+	bool getCompressData() {
+		return (compressData);
+	}
+
 	/*****************************************************************************
 	 ****************************************************************************/
 	string getOptionInfo(size_t _num, size_t _rep) {
@@ -0,0 +1,478 @@
+/**############################################################################
+#
+# Description: Averaging convergence times and error summaries over datasets
+#
+#
+# Copyright (C) 2024 by Hristina Radak
+#
+# Email: hristinaradak95@gmail.com
+#
+###############################################################################
+# The convergence times of any number of datasets and beta values are
+# averaged on the threads of a pool into the average_convergence.csv and
+# average_convergence_true.csv files of Python/averageConvergence.py. The
+# files of a convergence directory are split the way numpy splits a sum
+# into blocks of at most 128 values, the partial sums of the blocks are
+# found in parallel and merged in the order numpy adds them, thus the
+# averages are the same as those of np.average to the last bit.
+#
+# The rows of a summary file written with --summary are reduced the same
+# way, any thread taking its share of the rows into partial sums per
+# algorithm and beta value that are merged at the end.
+#############################################################################*/
+
+#ifndef __AGGREGATION_H
+#define __AGGREGATION_H
+
+/**############################################################################
+# INCLUDES
+#############################################################################*/
+
+#include <algorithm>
+#include <charconv>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "convergence.hpp"
+#include "csv_writer.hpp"
+#include "threadpool.hpp"
+#include "../../io/iodatafile.h"
+#include "../../io/iofile.h"
+
+/**############################################################################
+# NAMES
+#############################################################################*/
+
+using namespace std;
+
+/**############################################################################
+# DEFINES
+#############################################################################*/
+
+/******************************************************************************
+ * the largest block numpy sums without splitting it
+ *****************************************************************************/
+const size_t AGGREGATION_BLOCK_SIZE = 128;
+
+/**############################################################################
+# CLASS DECLARATIONS
+#############################################################################*/
+
+/******************************************************************************
+ *****************************************************************************/
+class Aggregation {
+
+	/** the threads the files respectively rows are shared out to **************/
+	ThreadPool &pool_;
+
+	/****************************************************************************
+	 * the values of a tab separated file of rows of numValues values
+	 ***************************************************************************/
+	static void readTable(const string &fileName, const size_t numValues,
+			vector<double> &values, size_t &numRows)
+	{
+		ifstream file(fileName.c_str(), ios::in | ios::binary);
+		string line;
+		if (!file.is_open()) {
+			cerr << "ERROR : COULD_NOT_OPEN_FILE : ";
+			cerr << "file = " << '"' << fileName << '"' << " : ";
+			cerr << "Aggregation::readTable" << endl;
+			throw IoFileExcept(ERROR_COULD_NOT_OPEN_FILE);
+		}
+		values.clear();
+		numRows = 0;
+		while (getline(file, line)) {
+			const char *p_char = line.data();
+			const char *p_end = line.data() + line.size();
+			size_t k = 0;
+			for (; k < numValues; k++) {
+				while (p_char < p_end && (*p_char == '\t' || *p_char == ' '
+						|| *p_char == '\r')) {
+					p_char++;
+				}
+				double value;
+				from_chars_result result = from_chars(p_char, p_end, value);
+				if (result.ec != errc()) {
+					break;
+				}
+				values.push_back(value);
+				p_char = result.ptr;
+			}
+			if (k == 0 && p_char == p_end) {
+				continue;
+			}
+			if (k < numValues) {
+				cerr << "ERROR : NOT_ENOUGH_VALUES : ";
+				cerr << "line = " << numRows + 1 << " : ";
+				cerr << "file = " << '"' << fileName << '"' << " : ";
+				cerr << "Aggregation::readTable" << endl;
+				throw IoDataFileExcept(ERROR_NOT_ENOUGH_VALUES);
+			}
+			numRows++;
+		}
+	}
+
+	/****************************************************************************
+	 * the sum of n values stride apart the way numpy's pairwise sum adds them
+	 ***************************************************************************/
+	static double pairwiseSum(const double *values, const size_t n,
+			const size_t stride)
+	{
+		if (n < 8) {
+			double result = 0.;
+			for (size_t i = 0; i < n; i++) {
+				result += values[i * stride];
+			}
+			return result;
+		}
+		if (n <= AGGREGATION_BLOCK_SIZE) {
+			double r[8];
+			size_t i;
+			for (unsigned j = 0; j < 8; j++) {
+				r[j] = values[j * stride];
+			}
+			for (i = 8; i < n - (n % 8); i += 8) {
+				for (unsigned j = 0; j < 8; j++) {
+					r[j] += values[(i + j) * stride];
+				}
+			}
+			double result = ((r[0] + r[1]) + (r[2] + r[3]))
+					+ ((r[4] + r[5]) + (r[6] + r[7]));
+			for (; i < n; i++) {
+				result += values[i * stride];
+			}
+			return result;
+		}
+		size_t n2 = n / 2;
+		n2 -= n2 % 8;
+		return pairwiseSum(values, n2, stride)
+				+ pairwiseSum(values + n2 * stride, n - n2, stride);
+	}
+
+	/****************************************************************************
+	 * the blocks numpy sums n values in, as first value and number of values
+	 ***************************************************************************/
+	static void splitBlocks(const size_t first, const size_t n,
+			vector<pair<size_t, size_t>> &blocks)
+	{
+		if (n <= AGGREGATION_BLOCK_SIZE) {
+			blocks.push_back(make_pair(first, n));
+			return;
+		}
+		size_t n2 = n / 2;
+		n2 -= n2 % 8;
+		splitBlocks(first, n2, blocks);
+		splitBlocks(first + n2, n - n2, blocks);
+	}
+
+	/****************************************************************************
+	 * merge the partial sums of the blocks of values first up to
+	 * first + n - 1 in the order numpy adds them, block is the next one
+	 ***************************************************************************/
+	static void mergeBlocks(const size_t n, const vector<vector<double>> &sums,
+			size_t &block, vector<double> &result)
+	{
+		if (n <= AGGREGATION_BLOCK_SIZE) {
+			result = sums[block++];
+			return;
+		}
+		size_t n2 = n / 2;
+		n2 -= n2 % 8;
+		vector<double> right;
+		mergeBlocks(n2, sums, block, result);
+		mergeBlocks(n - n2, sums, block, right);
+		for (size_t c = 0; c < result.size(); c++) {
+			result[c] += right[c];
+		}
+	}
+
+	/****************************************************************************
+	 * a row of values and a beta value the way averageConvergence.py writes
+	 * them
+	 ***************************************************************************/
+	static void writeRow(ofstream &file, const double *values,
+			const size_t numValues, const double beta)
+	{
+		for (size_t k = 0; k < numValues; k++) {
+			file << ConvergenceWriter::toPython(values[k]) << '\t';
+		}
+		file << ConvergenceWriter::toPython(beta) << '\n';
+	}
+
+	/****************************************************************************
+	 ***************************************************************************/
+	static void openOutput(ofstream &file, const string &fileName)
+	{
+		file.open(fileName.c_str(), ios::out | ios::trunc | ios::binary);
+		if (!file.is_open()) {
+			cerr << "ERROR : COULD_NOT_OPEN_FILE : ";
+			cerr << "file = " << '"' << fileName << '"' << " : ";
+			cerr << "Aggregation::openOutput" << endl;
+			throw IoFileExcept(ERROR_COULD_NOT_OPEN_FILE);
+		}
+	}
+
+public:
+	/****************************************************************************
+	 ***************************************************************************/
+	Aggregation(ThreadPool &pool)
+	: pool_(pool)
+	{
+	}
+
+	/****************************************************************************
+	 * average the files of a convergence directory of euler_analysis.py, the
+	 * ones whose names start with 0, into average_convergence.csv, and for a
+	 * convergence_true directory whether the estimates converge at all into
+	 * average_convergence_true.csv. The beta values are taken from the last
+	 * file.
+	 ***************************************************************************/
+	void averageConvergence(const string &dirName)
+	{
+		vector<string> fileNames;
+		for (const filesystem::directory_entry &entry
+				: filesystem::directory_iterator(dirName)) {
+			string name = entry.path().filename().string();
+			if (entry.is_regular_file() && name[0] == '0'
+					&& entry.path().extension() == ".csv") {
+				fileNames.push_back(entry.path().string());
+			}
+		}
+		sort(fileNames.begin(), fileNames.end());
+		if (fileNames.empty()) {
+			return;
+		}
+
+		/** the times are followed by the threshold and the beta value **********/
+		const size_t numValues = CONVERGENCE_NUM_COLUMNS + 2;
+		vector<double> last;
+		size_t numRows;
+		readTable(fileNames.back(), numValues, last, numRows);
+		const size_t numCells = numRows * CONVERGENCE_NUM_COLUMNS;
+
+		/** the partial sums of the blocks, found on the threads of the pool ****/
+		vector<pair<size_t, size_t>> blocks;
+		splitBlocks(0, fileNames.size(), blocks);
+		vector<vector<double>> sums(blocks.size());
+		vector<future<void>> futures;
+		for (size_t b = 0; b < blocks.size(); b++) {
+			futures.push_back(pool_.submit([&, b]() {
+				size_t first = blocks[b].first, n = blocks[b].second;
+				vector<double> times(n * numCells), values;
+				size_t rows;
+				for (size_t f = 0; f < n; f++) {
+					readTable(fileNames[first + f], numValues, values, rows);
+					if (rows != numRows) {
+						cerr << "ERROR : WRONG_NUMBER_OF_ROWS : ";
+						cerr << "file = " << '"' << fileNames[first + f] << '"' << " : ";
+						cerr << "Aggregation::averageConvergence" << endl;
+						throw IoDataFileExcept(ERROR_NOT_ENOUGH_VALUES);
+					}
+					for (size_t r = 0; r < numRows; r++) {
+						for (unsigned j = 0; j < CONVERGENCE_NUM_COLUMNS; j++) {
+							times[(r * CONVERGENCE_NUM_COLUMNS + j) * n + f]
+									= values[r * numValues + j];
+						}
+					}
+				}
+				sums[b].resize(numCells);
+				for (size_t c = 0; c < numCells; c++) {
+					sums[b][c] = pairwiseSum(&times[c * n], n, 1);
+				}
+			}));
+		}
+		for (future<void> &result : futures) {
+			result.get();
+		}
+
+		vector<double> average;
+		size_t block = 0;
+		mergeBlocks(fileNames.size(), sums, block, average);
+		for (double &value : average) {
+			value /= fileNames.size();
+		}
+
+		/** write the averages ***************************************************/
+		ofstream file;
+		openOutput(file, (filesystem::path(dirName) / "average_convergence.csv").string());
+		for (size_t r = 0; r < numRows; r++) {
+			writeRow(file, &average[r * CONVERGENCE_NUM_COLUMNS],
+					CONVERGENCE_NUM_COLUMNS, last[r * numValues + numValues - 1]);
+		}
+		file.close();
+
+		/** 1 if the estimates converge on average, -1 otherwise ****************/
+		if (filesystem::path(dirName).filename().string().rfind("convergence_true_", 0) != 0) {
+			return;
+		}
+		openOutput(file, (filesystem::path(dirName) / "average_convergence_true.csv").string());
+		for (size_t r = 0; r < numRows; r++) {
+			double converged[CONVERGENCE_NUM_COLUMNS];
+			for (unsigned j = 0; j < CONVERGENCE_NUM_COLUMNS; j++) {
+				converged[j] = (average[r * CONVERGENCE_NUM_COLUMNS + j] > 99) ? -1 : 1;
+			}
+			writeRow(file, converged, CONVERGENCE_NUM_COLUMNS,
+					last[r * numValues + numValues - 1]);
+		}
+	}
+
+	/****************************************************************************
+	 * average all convergence and convergence_true directories of a directory
+	 ***************************************************************************/
+	void averageConvergenceDirs(const string &dirName)
+	{
+		vector<string> dirNames;
+		for (const filesystem::directory_entry &entry
+				: filesystem::directory_iterator(dirName)) {
+			if (entry.is_directory() && entry.path().filename().string()
+					.rfind("convergence_", 0) == 0) {
+				dirNames.push_back(entry.path().string());
+			}
+		}
+		sort(dirNames.begin(), dirNames.end());
+		for (const string &name : dirNames) {
+			averageConvergence(name);
+			cout << "Averaged " << name << endl;
+		}
+	}
+
+	/****************************************************************************
+	 * reduce a summary file over its datasets into average_<name>: a row per
+	 * algorithm and beta value with the number of datasets, the mean of the
+	 * mean, RMS and final errors, the maximum of the maximum errors and the
+	 * mean Euler RMSEs
+	 ***************************************************************************/
+	void averageSummary(const string &fileName)
+	{
+		/** the columns of a summary row following dataset and algorithm ********/
+		enum {BETA_INDEX, BETA, NUM_SAMPLES, MEAN, RMS, MAX, FINAL, ROLL, PITCH,
+			YAW, NUM_COLUMNS};
+		struct Partial {
+			double beta = 0;
+			unsigned long numDatasets = 0;
+			double sums[NUM_COLUMNS] = {};
+			double maximum = 0;
+		};
+		typedef map<pair<string, unsigned long>, Partial> Partials;
+
+		ifstream file(fileName.c_str(), ios::in | ios::binary);
+		if (!file.is_open()) {
+			cerr << "ERROR : COULD_NOT_OPEN_FILE : ";
+			cerr << "file = " << '"' << fileName << '"' << " : ";
+			cerr << "Aggregation::averageSummary" << endl;
+			throw IoFileExcept(ERROR_COULD_NOT_OPEN_FILE);
+		}
+		vector<string> lines;
+		string line;
+		getline(file, line);
+		while (getline(file, line)) {
+			if (!line.empty()) {
+				lines.push_back(line);
+			}
+		}
+
+		/** any thread sums up its share of the rows *****************************/
+		size_t numTasks = min<size_t>(pool_.getNumThreads(), max<size_t>(lines.size(), 1));
+		vector<Partials> partials(numTasks);
+		vector<future<void>> futures;
+		for (size_t t = 0; t < numTasks; t++) {
+			futures.push_back(pool_.submit([&, t]() {
+				size_t first = lines.size() * t / numTasks;
+				size_t last = lines.size() * (t + 1) / numTasks;
+				for (size_t l = first; l < last; l++) {
+					stringstream fields(lines[l]);
+					string dataset, algorithm, field;
+					double values[NUM_COLUMNS];
+					unsigned long integers[NUM_COLUMNS] = {};
+					getline(fields, dataset, ',');
+					getline(fields, algorithm, ',');
+					for (unsigned c = 0; c < NUM_COLUMNS; c++) {
+						/** the beta index and the sample count are integers ********/
+						bool integer = (c == BETA_INDEX || c == NUM_SAMPLES);
+						bool valid = (bool) getline(fields, field, ',');
+						const char *p_first = field.data();
+						if (valid && integer) {
+							valid = from_chars(p_first, p_first + field.size(),
+									integers[c]).ec == errc();
+							values[c] = integers[c];
+						}
+						else if (valid) {
+							valid = from_chars(p_first, p_first + field.size(),
+									values[c]).ec == errc();
+						}
+						if (!valid) {
+							cerr << "ERROR : NOT_ENOUGH_VALUES : ";
+							cerr << "line = " << l + 2 << " : ";
+							cerr << "file = " << '"' << fileName << '"' << " : ";
+							cerr << "Aggregation::averageSummary" << endl;
+							throw IoDataFileExcept(ERROR_NOT_ENOUGH_VALUES);
+						}
+					}
+					Partial &partial = partials[t][make_pair(algorithm,
+							integers[BETA_INDEX])];
+					partial.beta = values[BETA];
+					partial.numDatasets++;
+					for (unsigned c = NUM_SAMPLES; c < NUM_COLUMNS; c++) {
+						partial.sums[c] += values[c];
+					}
+					partial.maximum = max(partial.maximum, values[MAX]);
+				}
+			}));
+		}
+		for (future<void> &result : futures) {
+			result.get();
+		}
+
+		/** merge the partial sums of all threads ********************************/
+		Partials total;
+		for (const Partials &partial : partials) {
+			for (const pair<const pair<string, unsigned long>, Partial> &p_partial : partial) {
+				Partial &sum = total[p_partial.first];
+				sum.beta = p_partial.second.beta;
+				sum.numDatasets += p_partial.second.numDatasets;
+				for (unsigned c = NUM_SAMPLES; c < NUM_COLUMNS; c++) {
+					sum.sums[c] += p_partial.second.sums[c];
+				}
+				sum.maximum = max(sum.maximum, p_partial.second.maximum);
+			}
+		}
+
+		filesystem::path path(fileName);
+		CsvWriter output;
+		string outputName = (path.parent_path() / ("average_"
+				+ path.filename().string())).string();
+		filesystem::remove(outputName);
+		output.open(outputName);
+		for (const char *field : {"algorithm", "betaIndex", "beta", "numDatasets",
+				"meanError", "rmsError", "maxError", "finalError", "rmseRoll",
+				"rmsePitch", "rmseYaw"}) {
+			output.writeField(field);
+		}
+		output.writeRow({});
+		for (const pair<const pair<string, unsigned long>, Partial> &p_sum : total) {
+			const Partial &sum = p_sum.second;
+			double n = sum.numDatasets;
+			output.writeField(p_sum.first.first);
+			output.writeField(p_sum.first.second);
+			output.writeField(sum.beta);
+			output.writeField(sum.numDatasets);
+			output.writeRow({sum.sums[MEAN] / n, sum.sums[RMS] / n, sum.maximum,
+					sum.sums[FINAL] / n, sum.sums[ROLL] / n, sum.sums[PITCH] / n,
+					sum.sums[YAW] / n});
+		}
+		output.close();
+		cout << "Averaged " << fileName << endl;
+	}
+};
+
+/**############################################################################
+# END OF FILE
+#############################################################################*/
+
+#endif /* __AGGREGATION_H *****************************************************/
@@ -0,0 +1,358 @@
+/**############################################################################
+#
+# Description: Streaming convergence analysis of the Euler angle results
+#
+#
+# Copyright (C) 2024 by Hristina Radak
+#
+# Email: hristinaradak95@gmail.com
+#
+###############################################################################
+# The analysis of Python/euler_analysis.py run on the results of the fusion
+# loop as they come instead of on the eulerResult files. For any algorithm
+# and axis the squared difference d(i) to the true angle of sample i is
+# taken, and for any threshold diff_max two times are found:
+#
+#   convergence       the last sample whose d differs from the d of the
+#                     final sample by more than diff_max
+#   convergence_true  the last sample whose RMSD, the moving average of d
+#                     over 11 samples divided by 10, exceeds diff_max
+#
+# both as round(i * 0.01, 1) seconds, 100 if there is none. Neither d nor
+# the averages are kept: the first time follows from the samples that are
+# larger respectively smaller than any later one, the second one is updated
+# with any sample. The angles are rounded to the 6 decimals of the result
+# files and the rows are formatted the way Python prints them, thus the
+# convergence files are the same as those of the script.
+#############################################################################*/
+
+#ifndef __CONVERGENCE_H
+#define __CONVERGENCE_H
+
+/**############################################################################
+# INCLUDES
+#############################################################################*/
+
+#include <charconv>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../../io/iofile.h"
+#include "csv_writer.hpp"
+
+/**############################################################################
+# NAMES
+#############################################################################*/
+
+using namespace std;
+
+/**############################################################################
+# DEFINES
+#############################################################################*/
+
+/******************************************************************************
+ * the thresholds in degrees, the same as diff_max of euler_analysis.py
+ *****************************************************************************/
+const double CONVERGENCE_DIFF_MAX[] = {0.125, 5};
+const unsigned CONVERGENCE_NUM_DIFF_MAX = 2;
+
+/******************************************************************************
+ * the moving window of the RMSD: filter_size + 1 samples
+ *****************************************************************************/
+const unsigned CONVERGENCE_FILTER_SIZE = 10;
+
+/******************************************************************************
+ * the time given if an estimate never leaves the threshold, and the time
+ * between two samples
+ *****************************************************************************/
+const double CONVERGENCE_NONE = 100;
+const double CONVERGENCE_SAMPLE_TIME = 0.01;
+
+/******************************************************************************
+ * madgwick, wilson and QGD times roll, pitch and yaw
+ *****************************************************************************/
+const unsigned CONVERGENCE_NUM_COLUMNS = 9;
+
+/**############################################################################
+# CLASS DECLARATIONS
+#############################################################################*/
+
+/******************************************************************************
+ * The convergence times of the results of a single beta value.
+ *****************************************************************************/
+class ConvergenceAnalyzer {
+
+	/** a sample index and its squared difference ******************************/
+	typedef pair<unsigned long, double> Sample;
+
+	/** the number of samples added ********************************************/
+	unsigned long numSamples_ = 0;
+
+	/** per column the samples larger respectively smaller than any later one,
+	 * in the order they were added *****************************************/
+	vector<Sample> larger_[CONVERGENCE_NUM_COLUMNS];
+	vector<Sample> smaller_[CONVERGENCE_NUM_COLUMNS];
+
+	/** per column the last CONVERGENCE_FILTER_SIZE + 1 squared differences
+	 * and the first one, which the average is started with ******************/
+	double window_[CONVERGENCE_NUM_COLUMNS][CONVERGENCE_FILTER_SIZE + 1];
+	double first_[CONVERGENCE_NUM_COLUMNS];
+
+	/** per threshold and column the last sample whose RMSD exceeds it ********/
+	long lastAbove_[CONVERGENCE_NUM_DIFF_MAX][CONVERGENCE_NUM_COLUMNS];
+
+	/****************************************************************************
+	 * the value a result file holds for v
+	 ***************************************************************************/
+	static double roundResult(const double v)
+	{
+		char text[400];
+		double result = v;
+		to_chars_result end = to_chars(text, text + sizeof(text), v,
+				chars_format::fixed, 6);
+		from_chars(text, end.ptr, result);
+		return result;
+	}
+
+	/****************************************************************************
+	 * round(i * 0.01, 1) the way Python rounds
+	 ***************************************************************************/
+	static double getTime(const unsigned long i)
+	{
+		char text[32];
+		double result = 0;
+		to_chars_result end = to_chars(text, text + sizeof(text),
+				double(i) * CONVERGENCE_SAMPLE_TIME, chars_format::fixed, 1);
+		from_chars(text, end.ptr, result);
+		return result;
+	}
+
+	/****************************************************************************
+	 * the last sample of a column whose squared difference differs from the
+	 * final one by more than diffMax, -1 if there is none. Any such sample
+	 * is larger or smaller than all later ones, the first of those found
+	 * from the end is the last one.
+	 ***************************************************************************/
+	long findLastApart(const unsigned j, const double diffMax) const
+	{
+		double last = larger_[j].back().second;
+		long result = -1;
+		for (size_t k = larger_[j].size(); k-- > 0;) {
+			if (fabs(last - larger_[j][k].second) > diffMax) {
+				result = larger_[j][k].first;
+				break;
+			}
+		}
+		for (size_t k = smaller_[j].size(); k-- > 0;) {
+			if (long(smaller_[j][k].first) <= result) {
+				break;
+			}
+			if (fabs(last - smaller_[j][k].second) > diffMax) {
+				result = smaller_[j][k].first;
+				break;
+			}
+		}
+		return result;
+	}
+
+public:
+	/****************************************************************************
+	 ***************************************************************************/
+	ConvergenceAnalyzer()
+	{
+		for (unsigned k = 0; k < CONVERGENCE_NUM_DIFF_MAX; k++) {
+			for (unsigned j = 0; j < CONVERGENCE_NUM_COLUMNS; j++) {
+				lastAbove_[k][j] = -1;
+			}
+		}
+	}
+
+	/****************************************************************************
+	 * add the Euler angles of the next sample: true, Madgwick, Wilson and QGD
+	 * roll, pitch and yaw one after another
+	 ***************************************************************************/
+	void add(const double *euler)
+	{
+		const double b = 1.0 / (CONVERGENCE_FILTER_SIZE + 1);
+		const unsigned long n = numSamples_++;
+
+		for (unsigned j = 0; j < CONVERGENCE_NUM_COLUMNS; j++) {
+			double difference = roundResult(euler[3 + j]) - roundResult(euler[j % 3]);
+			double d = difference * difference;
+
+			/** the samples the final one may differ from *************************/
+			while (!larger_[j].empty() && larger_[j].back().second <= d) {
+				larger_[j].pop_back();
+			}
+			larger_[j].push_back(Sample(n, d));
+			while (!smaller_[j].empty() && smaller_[j].back().second >= d) {
+				smaller_[j].pop_back();
+			}
+			smaller_[j].push_back(Sample(n, d));
+
+			/** the moving average, started as if the first value had been there
+			 * before, the way lfilter with lfilter_zi does **********************/
+			if (n == 0) {
+				first_[j] = d;
+			}
+			window_[j][n % (CONVERGENCE_FILTER_SIZE + 1)] = d;
+			double sum = 0;
+			for (unsigned m = 0; m <= CONVERGENCE_FILTER_SIZE; m++) {
+				sum += b * ((m <= n) ? window_[j][(n - m) % (CONVERGENCE_FILTER_SIZE + 1)]
+						: first_[j]);
+			}
+			double rmsd = sqrt(sum / CONVERGENCE_FILTER_SIZE);
+			for (unsigned k = 0; k < CONVERGENCE_NUM_DIFF_MAX; k++) {
+				if (rmsd > CONVERGENCE_DIFF_MAX[k]) {
+					lastAbove_[k][j] = n;
+				}
+			}
+		}
+	}
+
+	/****************************************************************************
+	 ***************************************************************************/
+	unsigned long getNumSamples() const
+	{
+		return numSamples_;
+	}
+
+	/****************************************************************************
+	 * the times of all thresholds, a time found for none of them stays the
+	 * one of the threshold before, the way euler_analysis.py keeps it
+	 ***************************************************************************/
+	void getTimes(vector<vector<double>> &times,
+			vector<vector<double>> &timesTrue) const
+	{
+		vector<double> row(CONVERGENCE_NUM_COLUMNS, CONVERGENCE_NONE);
+		vector<double> rowTrue(CONVERGENCE_NUM_COLUMNS, CONVERGENCE_NONE);
+		times.clear();
+		timesTrue.clear();
+		for (unsigned k = 0; k < CONVERGENCE_NUM_DIFF_MAX; k++) {
+			for (unsigned j = 0; j < CONVERGENCE_NUM_COLUMNS && numSamples_ > 0; j++) {
+				long i = findLastApart(j, CONVERGENCE_DIFF_MAX[k]);
+				if (i >= 0) {
+					row[j] = getTime(i);
+				}
+				if (lastAbove_[k][j] >= 0) {
+					rowTrue[j] = getTime(lastAbove_[k][j]);
+				}
+			}
+			times.push_back(row);
+			timesTrue.push_back(rowTrue);
+		}
+	}
+};
+
+/******************************************************************************
+ * Appends the convergence times of the beta values of a dataset to the
+ * convergence_k and convergence_true_k directories of euler_analysis.py.
+ *****************************************************************************/
+class ConvergenceWriter {
+
+	/** the directory holding the convergence directories **********************/
+	string dirName_;
+
+	/****************************************************************************
+	 * the times of a beta value, the threshold and the beta value
+	 ***************************************************************************/
+	static void writeRow(const string &fileName, const vector<double> &times,
+			const double diffMax, const double beta)
+	{
+		ofstream file(fileName.c_str(), ios::app | ios::binary);
+		char text[64];
+		if (!file.is_open()) {
+			cerr << "ERROR : COULD_NOT_OPEN_FILE : ";
+			cerr << "file = " << '"' << fileName << '"' << " : ";
+			cerr << "ConvergenceWriter::writeRow" << endl;
+			throw IoFileExcept(ERROR_COULD_NOT_OPEN_FILE);
+		}
+		for (double time : times) {
+			file << toPython(time) << '\t';
+		}
+		/** the thresholds are written as given, 5 rather than 5.0 ****************/
+		to_chars_result end = to_chars(text, text + sizeof(text), diffMax);
+		file << string(text, end.ptr) << '\t' << toPython(beta) << '\n';
+	}
+
+public:
+	/****************************************************************************
+	 * a double the way Python's str() prints it
+	 ***************************************************************************/
+	static string toPython(const double v)
+	{
+		char text[64];
+		double a = fabs(v);
+		bool scientific = (a != 0 && (a < 1e-4 || a >= 1e16)) || !isfinite(v);
+		to_chars_result end = to_chars(text, text + sizeof(text), v,
+				scientific ? chars_format::scientific : chars_format::fixed);
+		string result(text, end.ptr);
+		if (isfinite(v) && result.find_first_of(".e") == string::npos) {
+			result += ".0";
+		}
+		return result;
+	}
+
+	/****************************************************************************
+	 ***************************************************************************/
+	ConvergenceWriter(const string &dirName = "")
+	: dirName_(dirName)
+	{
+	}
+
+	/****************************************************************************
+	 ***************************************************************************/
+	void setDirName(const string &dirName)
+	{
+		dirName_ = dirName;
+	}
+
+	/****************************************************************************
+	 ***************************************************************************/
+	const string &getDirName() const
+	{
+		return dirName_;
+	}
+
+	/****************************************************************************
+	 * append a row per beta value to the file name.csv of any threshold, the
+	 * beta values are rounded the way the result files hold them
+	 ***************************************************************************/
+	void write(const string &name, const vector<ConvergenceAnalyzer> &analyzers,
+			const vector<double> &betas) const
+	{
+		vector<string> dirs, dirsTrue;
+		for (unsigned k = 0; k < CONVERGENCE_NUM_DIFF_MAX; k++) {
+			dirs.push_back((filesystem::path(dirName_)
+					/ ("convergence_" + to_string(k))).string());
+			dirsTrue.push_back((filesystem::path(dirName_)
+					/ ("convergence_true_" + to_string(k))).string());
+			filesystem::create_directories(dirs.back());
+			filesystem::create_directories(dirsTrue.back());
+		}
+
+		vector<vector<double>> times, timesTrue;
+		for (size_t b = 0; b < analyzers.size(); b++) {
+			double beta = CsvWriter::round(betas[b]);
+
+			analyzers[b].getTimes(times, timesTrue);
+			for (unsigned k = 0; k < CONVERGENCE_NUM_DIFF_MAX; k++) {
+				writeRow(dirs[k] + "/" + name + ".csv", times[k],
+						CONVERGENCE_DIFF_MAX[k], beta);
+				writeRow(dirsTrue[k] + "/" + name + ".csv", timesTrue[k],
+						CONVERGENCE_DIFF_MAX[k], beta);
+			}
+		}
+	}
+};
+
+/**############################################################################
+# END OF FILE
+#############################################################################*/
+
+#endif /* __CONVERGENCE_H *****************************************************/
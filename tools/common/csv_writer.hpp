@@ -1,9 +1,17 @@
 #ifndef INC_CSV_WRITER
 #define INC_CSV_WRITER
 
+#include <algorithm>
+#include <charconv>
 #include <fstream>
+#include <iostream>
 #include <ostream>
 #include <stdarg.h>
+#include <string>
+#include <vector>
+
+#include "../../io/iobinarydatafile.h"
+#include "../../io/iofile.h"
 using namespace std;
 
 void create_csv_header(std::string filename, const char *arg, ... ){
@@ -75,4 +83,191 @@ void delete_csv_file(std::string filename)
     }
 }
 
+/******************************************************************************
+ * Appends rows of doubles to a CSV file that is kept open until the writer
+ * is closed or destroyed. Values are formatted the way std::to_string does,
+ * i.e. fixed with 6 decimals (integer fields without any), each one followed
+ * by a comma, thus the files are identical to those of write_csv_file. Rows
+ * are collected in a buffer and written in blocks of its size.
+ *****************************************************************************/
+class CsvWriter {
+
+	/** the file appended to ***************************************************/
+	ofstream file_;
+	string fileName_;
+
+	/** the rows not written yet ***********************************************/
+	vector<char> buffer_;
+	size_t size_ = 0;
+
+public:
+	/****************************************************************************
+	 ***************************************************************************/
+	CsvWriter(const size_t bufferSize = 1 << 16)
+	: buffer_(std::max<size_t>(bufferSize, 1024))
+	{
+	}
+
+	CsvWriter(CsvWriter &&) = default;
+
+	/****************************************************************************
+	 ***************************************************************************/
+	~CsvWriter()
+	{
+		try {
+			close();
+		}
+		catch (...) {
+		}
+	}
+
+	/****************************************************************************
+	 * open a file to append to, an open file is closed before
+	 ***************************************************************************/
+	void open(const string &fileName)
+	{
+		close();
+		fileName_ = fileName;
+		file_.open(fileName_, std::ios::app | std::ios::binary);
+		if (!file_.is_open()) {
+			cerr << "ERROR : COULD_NOT_OPEN_FILE : ";
+			cerr << "file = " << '"' << fileName_ << '"' << " : ";
+			cerr << "CsvWriter::open" << endl;
+			throw IoFileExcept(ERROR_COULD_NOT_OPEN_FILE);
+		}
+	}
+
+	/****************************************************************************
+	 * append a row of numValues values
+	 ***************************************************************************/
+	void writeRow(const double *values, const size_t numValues)
+	{
+		for (size_t k = 0; k < numValues; k++) {
+			writeField(values[k]);
+		}
+		if (buffer_.size() - size_ < 1) {
+			flush();
+		}
+		buffer_[size_++] = '\n';
+	}
+
+	/****************************************************************************
+	 * append a text field followed by a comma to the current row, the row is
+	 * ended by the next writeRow
+	 ***************************************************************************/
+	void writeField(const string &field)
+	{
+		if (buffer_.size() - size_ < field.size() + 1) {
+			flush();
+		}
+		if (buffer_.size() < field.size() + 1) {
+			buffer_.resize(field.size() + 1);
+		}
+		copy(field.begin(), field.end(), buffer_.begin() + size_);
+		size_ += field.size();
+		buffer_[size_++] = ',';
+	}
+
+	/****************************************************************************
+	 * append a value followed by a comma to the current row, formatted as the
+	 * values of writeRow
+	 ***************************************************************************/
+	void writeField(const double value)
+	{
+		/** a value takes at most 309 digits, the sign, point, decimals and comma */
+		const size_t maxChars = 320;
+		if (buffer_.size() - size_ < maxChars + 1) {
+			flush();
+		}
+		to_chars_result result = to_chars(buffer_.data() + size_,
+				buffer_.data() + buffer_.size(), value, chars_format::fixed, 6);
+		size_ = result.ptr - buffer_.data();
+		buffer_[size_++] = ',';
+	}
+
+	/****************************************************************************
+	 * a value the way it is read back from a row written, e.g. a beta value
+	 * of 0.30000000000000004 as 0.3
+	 ***************************************************************************/
+	static double round(const double value)
+	{
+		char text[400];
+		double rounded = value;
+		to_chars_result end = to_chars(text, text + sizeof(text), value,
+				chars_format::fixed, 6);
+		from_chars(text, end.ptr, rounded);
+		return rounded;
+	}
+
+	/****************************************************************************
+	 * append an integer, e.g. an index or a count, followed by a comma to the
+	 * current row, written without decimals
+	 ***************************************************************************/
+	void writeField(const unsigned long value)
+	{
+		/** a value takes at most 20 digits and the comma */
+		const size_t maxChars = 21;
+		if (buffer_.size() - size_ < maxChars + 1) {
+			flush();
+		}
+		to_chars_result result = to_chars(buffer_.data() + size_,
+				buffer_.data() + buffer_.size(), value);
+		size_ = result.ptr - buffer_.data();
+		buffer_[size_++] = ',';
+	}
+
+	/****************************************************************************
+	 ***************************************************************************/
+	void writeRow(initializer_list<double> values)
+	{
+		writeRow(values.begin(), values.size());
+	}
+
+	/****************************************************************************
+	 ***************************************************************************/
+	bool isOpen() const
+	{
+		return file_.is_open();
+	}
+
+	/****************************************************************************
+	 * write the rows collected so far, they are dropped if that fails
+	 ***************************************************************************/
+	void flush()
+	{
+		size_t size = size_;
+		size_ = 0;
+		if (size > 0 && file_.is_open() && !file_.write(buffer_.data(), size)) {
+			cerr << "ERROR : COULD_NOT_WRITE_FILE : ";
+			cerr << "file = " << '"' << fileName_ << '"' << " : ";
+			cerr << "CsvWriter::flush" << endl;
+			throw IoFileExcept(ERROR_COULD_NOT_WRITE_FILE);
+		}
+	}
+
+	/****************************************************************************
+	 * the file is closed even if writing the rows left fails
+	 ***************************************************************************/
+	void close()
+	{
+		if (!file_.is_open()) {
+			return;
+		}
+		try {
+			flush();
+		}
+		catch (...) {
+			file_.close();
+			throw;
+		}
+		file_.close();
+		if (file_.fail()) {
+			cerr << "ERROR : COULD_NOT_WRITE_FILE : ";
+			cerr << "file = " << '"' << fileName_ << '"' << " : ";
+			cerr << "CsvWriter::close" << endl;
+			throw IoFileExcept(ERROR_COULD_NOT_WRITE_FILE);
+		}
+	}
+};
+
 #endif
@@ -0,0 +1,342 @@
+/**############################################################################
+#
+# Description: Reading the sensor and truth data of a recording
+#
+#
+# Copyright (C) 2024 by Hristina Radak
+#
+# Email: hristinaradak95@gmail.com
+#
+###############################################################################
+# A recording consists of a gyroscope, an accelerometer, a magnetometer and a
+# true quaternion data file. Each of them is either a text data file (.dat)
+# or a binary data file (.bin). The data is read into 4 x n matrices, either
+# as a whole or chunk by chunk.
+#############################################################################*/
+
+#ifndef __DATASET_H
+#define __DATASET_H
+
+/**############################################################################
+# INCLUDES
+#############################################################################*/
+
+#include <armadillo>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../../io/iobinarydatafile.h"
+#include "../../io/iomappeddatafile.h"
+#include "datasetcatalog.hpp"
+#include "threadpool.hpp"
+
+/**############################################################################
+# NAMES
+#############################################################################*/
+
+using namespace std;
+using namespace arma;
+
+/**############################################################################
+# CLASS DECLARATIONS
+#############################################################################*/
+
+/******************************************************************************
+ * Reads the channels of a single data file. Binary data files are recognized
+ * by their suffix, any other file is read as text data file.
+ *****************************************************************************/
+class DataFileReader {
+
+	/** the name of the data file **********************************************/
+	string fileName_;
+
+	/** readers for the two data file formats **********************************/
+	IoMappedDataFile textFile_;
+	IoBinaryDataFile binaryFile_;
+
+	/** the catalog entry of the data file, NULL if there is none **************/
+	const DatasetCatalog::Entry *p_entry_ = NULL;
+
+public:
+	/****************************************************************************
+	 ***************************************************************************/
+	DataFileReader(const string &fileName = "")
+	{
+		setFileName(fileName);
+	}
+
+	/****************************************************************************
+	 ***************************************************************************/
+	void setFileName(const string &fileName)
+	{
+		fileName_ = fileName;
+		p_entry_ = NULL;
+		if (isBinaryDataFile(fileName_)) {
+			binaryFile_.setFileName(fileName_);
+		}
+		else {
+			textFile_.setFileName(fileName_);
+		}
+	}
+
+	/****************************************************************************
+	 ***************************************************************************/
+	const string &getFileName() const
+	{
+		return fileName_;
+	}
+
+	/****************************************************************************
+	 * convert a single key of a text data file on the threads of the pool and
+	 * the calling one, NULL converts it on the calling thread only
+	 ***************************************************************************/
+	void setParsePool(ThreadPool *p_pool)
+	{
+		if (p_pool == NULL) {
+			textFile_.setNumThreads(1, NULL);
+			return;
+		}
+		textFile_.setNumThreads(p_pool->getNumThreads() + 1,
+				[p_pool](function<void()> task) { return p_pool->submit(move(task)); });
+	}
+
+	/****************************************************************************
+	 * take the number of samples and the positions of the keys from the
+	 * catalog entry of the data file instead of searching the file
+	 ***************************************************************************/
+	void setCatalogEntry(const DatasetCatalog::Entry *p_entry)
+	{
+		p_entry_ = p_entry;
+		if (p_entry_ != NULL && !isBinaryDataFile(fileName_)) {
+			for (const IoMappedDataFile::KeyPosition &keyPosition : p_entry_->keys) {
+				textFile_.setKeyPosition(keyPosition);
+			}
+		}
+	}
+
+	/****************************************************************************
+	 * check the keys of a section against the catalog entry, if any
+	 ***************************************************************************/
+	void check(const string &section, const vector<string> &keys,
+			const unsigned long numSamples)
+	{
+		if (p_entry_ != NULL) {
+			DatasetCatalog::check(*p_entry_, fileName_, section, keys, numSamples);
+		}
+	}
+
+	/****************************************************************************
+	 * number of samples per channel as given with the GLOBAL_DATA section
+	 * respectively the header of a binary data file
+	 ***************************************************************************/
+	unsigned long getNumSamples()
+	{
+		unsigned long numSamples;
+		if (p_entry_ != NULL) {
+			return p_entry_->numSamples;
+		}
+		if (isBinaryDataFile(fileName_)) {
+			return binaryFile_.getNumSamples();
+		}
+		textFile_.getValue(numSamples, "numSamples", "GLOBAL_DATA");
+		return numSamples;
+	}
+
+	/****************************************************************************
+	 * read size samples starting at sample first of the keys of a section into
+	 * the rows of data starting at firstRow, sample first is stored in column 0
+	 ***************************************************************************/
+	void read(Mat<double> &data, const string &section,
+			const vector<string> &keys, const unsigned firstRow,
+			const unsigned long first, const unsigned long size)
+	{
+		try {
+			for (unsigned k = 0; k < keys.size(); k++) {
+				if (isBinaryDataFile(fileName_)) {
+					binaryFile_.getValues(data.memptr() + firstRow + k, keys[k],
+							section, size, data.n_rows, first);
+				}
+				else {
+					textFile_.getValues(data.memptr() + firstRow + k, keys[k],
+							section, size, data.n_rows, first);
+				}
+			}
+		}
+		catch (...) {
+			cerr << "ERROR : UNKNOWN : ";
+			cerr << "file = " << '"' << fileName_ << '"' << " : ";
+			cerr << "DataFileReader::read" << endl;
+			throw;
+		}
+	}
+};
+
+/******************************************************************************
+ * The sensor and truth data of (a chunk of) a recording as quaternions:
+ * gyro = {0, gyro_x, gyro_y, gyro_z}, acc = {0, acc_x, acc_y, acc_z},
+ * mag = {0, mag_x, mag_y, mag_z} and quat = {qw, qx, qy, qz}. Column 0 holds
+ * sample first of the recording.
+ *****************************************************************************/
+class Dataset {
+public:
+	/** the number of samples of the whole recording ***************************/
+	unsigned long numSamples = 0;
+
+	/** the first sample and the number of samples held by the matrices ********/
+	unsigned long first = 0;
+	unsigned long size = 0;
+
+	/****************************************************************************
+	 ***************************************************************************/
+	Mat<double> gyro, acc, mag, quat;
+};
+
+/******************************************************************************
+ * Reads the four data files of a recording into a @ref Dataset. Any file has
+ * got its own reader, thus reading chunk by chunk continues within each file
+ * where the previous chunk ended. Given a thread pool, the four files are
+ * read concurrently.
+ *****************************************************************************/
+class DatasetReader {
+
+	/** readers for gyroscope, accelerometer, magnetometer and true quaternion */
+	DataFileReader gyroFile_, accFile_, magFile_, quatFile_;
+
+	/** the pool to read the files on, NULL reads them one after another *******/
+	ThreadPool *p_pool_;
+
+public:
+	/****************************************************************************
+	 ***************************************************************************/
+	DatasetReader(const string &gyroFileName, const string &accFileName,
+			const string &magFileName, const string &quatFileName)
+	: gyroFile_(gyroFileName), accFile_(accFileName), magFile_(magFileName),
+	  quatFile_(quatFileName), p_pool_(NULL)
+	{
+	}
+
+	/****************************************************************************
+	 * the pool the ranges of a single key of a text data file are converted
+	 * on, it is shared by the four files and must not be the one reading
+	 * them, as they wait for their ranges. NULL converts each key on the
+	 * thread reading its file
+	 ***************************************************************************/
+	void setParsePool(ThreadPool *p_pool)
+	{
+		for (DataFileReader *p_file : {&gyroFile_, &accFile_, &magFile_, &quatFile_}) {
+			p_file->setParsePool(p_pool);
+		}
+	}
+
+	/****************************************************************************
+	 ***************************************************************************/
+	void setThreadPool(ThreadPool *p_pool)
+	{
+		p_pool_ = p_pool;
+	}
+
+	/****************************************************************************
+	 * use the entries of the catalog for the four data files, files without
+	 * a valid entry are searched as usual
+	 ***************************************************************************/
+	void setCatalog(const DatasetCatalog *p_catalog)
+	{
+		for (DataFileReader *p_file : {&gyroFile_, &accFile_, &magFile_, &quatFile_}) {
+			p_file->setCatalogEntry((p_catalog == NULL) ? NULL
+					: p_catalog->find(p_file->getFileName()));
+		}
+	}
+
+	/****************************************************************************
+	 * report missing keys or short files of the recording by means of the
+	 * catalog before anything is read
+	 ***************************************************************************/
+	void check()
+	{
+		unsigned long numSamples = getNumSamples();
+		gyroFile_.check("GYRO_DATA", {"gyro_x", "gyro_y", "gyro_z"}, numSamples);
+		accFile_.check("ACC_DATA", {"acc_x", "acc_y", "acc_z"}, numSamples);
+		magFile_.check("MAG_DATA", {"mag_x", "mag_y", "mag_z"}, numSamples);
+		quatFile_.check("QUAT_DATA", {"quat_w", "quat_x", "quat_y", "quat_z"},
+				numSamples);
+	}
+
+	/****************************************************************************
+	 * the number of samples of the recording is taken from the gyroscope file
+	 ***************************************************************************/
+	unsigned long getNumSamples()
+	{
+		return gyroFile_.getNumSamples();
+	}
+
+	/****************************************************************************
+	 * read up to size samples starting at sample first, the number of samples
+	 * read is returned
+	 ***************************************************************************/
+	unsigned long read(Dataset &data, const unsigned long first,
+			const unsigned long size)
+	{
+		data.numSamples = getNumSamples();
+		data.first = first;
+		data.size = (first < data.numSamples) ? data.numSamples - first : 0;
+		if (data.size > size) {
+			data.size = size;
+		}
+
+		data.gyro.zeros(4, data.size);
+		data.acc.zeros(4, data.size);
+		data.mag.zeros(4, data.size);
+		data.quat.zeros(4, data.size);
+		if (data.size == 0) {
+			return 0;
+		}
+
+		vector<function<void()>> jobs = {
+			[&] { gyroFile_.read(data.gyro, "GYRO_DATA",
+					{"gyro_x", "gyro_y", "gyro_z"}, 1, first, data.size); }, //- y, z for mdw dataset
+			[&] { accFile_.read(data.acc, "ACC_DATA",
+					{"acc_x", "acc_y", "acc_z"}, 1, first, data.size); },
+			[&] { magFile_.read(data.mag, "MAG_DATA",
+					{"mag_x", "mag_y", "mag_z"}, 1, first, data.size); },
+			[&] { quatFile_.read(data.quat, "QUAT_DATA",
+					{"quat_w", "quat_x", "quat_y", "quat_z"}, 0, first, data.size); }
+		};
+
+		if (p_pool_ == NULL) {
+			for (function<void()> &job : jobs) {
+				job();
+			}
+			return data.size;
+		}
+
+		/** join all files before passing on the first error *******************/
+		vector<future<void>> results;
+		for (function<void()> &job : jobs) {
+			results.push_back(p_pool_->submit(job));
+		}
+		for (future<void> &result : results) {
+			result.wait();
+		}
+		for (future<void> &result : results) {
+			result.get();
+		}
+		return data.size;
+	}
+
+	/****************************************************************************
+	 * read the whole recording
+	 ***************************************************************************/
+	unsigned long read(Dataset &data)
+	{
+		return read(data, 0, getNumSamples());
+	}
+};
+
+/**############################################################################
+# END OF FILE
+#############################################################################*/
+
+#endif /* __DATASET_H *********************************************************/
@@ -0,0 +1,274 @@
+/**############################################################################
+#
+# Description: In-process cache of decoded recordings
+#
+#
+# Copyright (C) 2024 by Hristina Radak
+#
+# Email: hristinaradak95@gmail.com
+#
+###############################################################################
+# Running several configuration files or repetitions in one process reads the
+# very same data files again and again. The cache keeps decoded recordings
+# keyed by the resolved file names and their modification times, thus a
+# recording is read once as long as its files do not change. A recording can
+# be prefetched on a background thread, e.g. the one of the next configuration
+# file while the current one is running.
+#############################################################################*/
+
+#ifndef __DATASETCACHE_H
+#define __DATASETCACHE_H
+
+/**############################################################################
+# INCLUDES
+#############################################################################*/
+
+#include <filesystem>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "dataset.hpp"
+
+/**############################################################################
+# NAMES
+#############################################################################*/
+
+using namespace std;
+
+/**############################################################################
+# CLASS DECLARATIONS
+#############################################################################*/
+
+/******************************************************************************
+ * Cache of whole recordings. The least recently used recording is dropped if
+ * more than the maximum number of recordings would be kept. Any recording is
+ * held as a shared future, thus a recording still being prefetched is waited
+ * for instead of being read a second time. The cache may be used from
+ * several threads.
+ *****************************************************************************/
+class DatasetCache {
+
+	/****************************************************************************
+	 * identifies a data file by its resolved name, modification time and size
+	 ***************************************************************************/
+	struct FileStamp {
+		string path;
+		filesystem::file_time_type time;
+		uintmax_t size;
+
+		bool operator==(const FileStamp &stamp) const
+		{
+			return path == stamp.path && time == stamp.time && size == stamp.size;
+		}
+	};
+
+	/****************************************************************************
+	 * a cached recording and the stamps of its four data files
+	 ***************************************************************************/
+	struct Entry {
+		vector<FileStamp> stamps;
+		shared_future<shared_ptr<const Dataset>> data;
+	};
+
+	/** the cached recordings, most recently used first ************************/
+	list<Entry> entries_;
+
+	/** the maximum number of recordings kept, 0 means no limit ****************/
+	size_t maxEntries_;
+
+	/** number of recordings taken from the cache respectively read ***********/
+	size_t hits_ = 0, misses_ = 0;
+
+	/** the pool to read the data files on *************************************/
+	ThreadPool *p_pool_ = NULL;
+
+	/** the pool to convert the keys of the text data files on *****************/
+	ThreadPool *p_parsePool_ = NULL;
+
+	/** the catalog of the data files, if any **********************************/
+	const DatasetCatalog *p_catalog_ = NULL;
+
+	/** guards entries_ and the counters ***************************************/
+	mutable mutex mutex_;
+
+	/****************************************************************************
+	 ***************************************************************************/
+	static FileStamp getStamp(const string &fileName)
+	{
+		FileStamp stamp;
+		stamp.path = filesystem::canonical(fileName).string();
+		stamp.time = filesystem::last_write_time(stamp.path);
+		stamp.size = filesystem::file_size(stamp.path);
+		return stamp;
+	}
+
+	/****************************************************************************
+	 * find the entry of the four data files or add one that reads them by
+	 * means of policy, launch::deferred reads them in the thread waiting for
+	 * the recording first, launch::async reads them on a background thread
+	 ***************************************************************************/
+	shared_future<shared_ptr<const Dataset>> find(const string &gyroFileName,
+			const string &accFileName, const string &magFileName,
+			const string &quatFileName, const launch policy)
+	{
+		vector<FileStamp> stamps = {getStamp(gyroFileName), getStamp(accFileName),
+				getStamp(magFileName), getStamp(quatFileName)};
+		list<Entry> stale;
+		lock_guard<mutex> lock(mutex_);
+
+		/** move a cached recording to the front and return it ******************/
+		for (auto p_entry = entries_.begin(); p_entry != entries_.end(); p_entry++) {
+			if (p_entry->stamps == stamps) {
+				entries_.splice(entries_.begin(), entries_, p_entry);
+				hits_++;
+				return entries_.front().data;
+			}
+		}
+
+		/** otherwise drop recordings of changed files and add a new one, the
+		 * dropped ones are destroyed after unlocking as they may still be read */
+		for (auto p_entry = entries_.begin(); p_entry != entries_.end();) {
+			auto p_next = next(p_entry);
+			for (size_t k = 0; k < stamps.size(); k++) {
+				if (p_entry->stamps[k].path == stamps[k].path
+						&& !(p_entry->stamps[k] == stamps[k])) {
+					stale.splice(stale.end(), entries_, p_entry);
+					break;
+				}
+			}
+			p_entry = p_next;
+		}
+		ThreadPool *p_pool = (policy == launch::deferred) ? p_pool_ : NULL;
+		ThreadPool *p_parsePool = p_parsePool_;
+		const DatasetCatalog *p_catalog = p_catalog_;
+		entries_.push_front({stamps, async(policy,
+				[gyroFileName, accFileName, magFileName, quatFileName, p_pool,
+				 p_parsePool, p_catalog] {
+			shared_ptr<Dataset> data = make_shared<Dataset>();
+			DatasetReader reader(gyroFileName, accFileName, magFileName, quatFileName);
+			reader.setThreadPool(p_pool);
+			reader.setParsePool(p_parsePool);
+			reader.setCatalog(p_catalog);
+			reader.read(*data);
+			return shared_ptr<const Dataset>(data);
+		}).share()});
+		misses_++;
+		if (maxEntries_ > 0 && entries_.size() > maxEntries_) {
+			stale.splice(stale.end(), entries_, prev(entries_.end()));
+		}
+		return entries_.front().data;
+	}
+
+public:
+	/****************************************************************************
+	 ***************************************************************************/
+	DatasetCache(const size_t maxEntries = 0)
+	: maxEntries_(maxEntries)
+	{
+	}
+
+	/****************************************************************************
+	 * get the whole recording of the four data files, it is read only if not
+	 * cached yet or any of the files has changed since
+	 ***************************************************************************/
+	shared_ptr<const Dataset> get(const string &gyroFileName,
+			const string &accFileName, const string &magFileName,
+			const string &quatFileName)
+	{
+		shared_future<shared_ptr<const Dataset>> data;
+		try {
+			data = find(gyroFileName, accFileName, magFileName, quatFileName,
+					launch::deferred);
+			return data.get();
+		}
+		catch (filesystem::filesystem_error &e) {
+			cerr << "ERROR : " << e.what() << " : ";
+			cerr << "DatasetCache::get" << endl;
+			throw;
+		}
+		catch (...) {
+			cerr << "ERROR : UNKNOWN : ";
+			cerr << "DatasetCache::get" << endl;
+			throw;
+		}
+	}
+
+	/****************************************************************************
+	 * start reading the whole recording of the four data files on a background
+	 * thread unless it is cached already, a later @ref get waits for it
+	 ***************************************************************************/
+	void prefetch(const string &gyroFileName, const string &accFileName,
+			const string &magFileName, const string &quatFileName)
+	{
+		try {
+			find(gyroFileName, accFileName, magFileName, quatFileName,
+					launch::async);
+		}
+		catch (filesystem::filesystem_error &e) {
+			cerr << "ERROR : " << e.what() << " : ";
+			cerr << "DatasetCache::prefetch" << endl;
+			throw;
+		}
+		catch (...) {
+			cerr << "ERROR : UNKNOWN : ";
+			cerr << "DatasetCache::prefetch" << endl;
+			throw;
+		}
+	}
+
+	/****************************************************************************
+	 ***************************************************************************/
+	void setThreadPool(ThreadPool *p_pool)
+	{
+		p_pool_ = p_pool;
+	}
+
+	/****************************************************************************
+	 * see DatasetReader::setParsePool
+	 ***************************************************************************/
+	void setParsePool(ThreadPool *p_parsePool)
+	{
+		p_parsePool_ = p_parsePool;
+	}
+
+	/****************************************************************************
+	 ***************************************************************************/
+	void setCatalog(const DatasetCatalog *p_catalog)
+	{
+		p_catalog_ = p_catalog;
+	}
+
+	/****************************************************************************
+	 ***************************************************************************/
+	void clear()
+	{
+		lock_guard<mutex> lock(mutex_);
+		entries_.clear();
+	}
+
+	/****************************************************************************
+	 ***************************************************************************/
+	size_t getNumHits() const
+	{
+		lock_guard<mutex> lock(mutex_);
+		return hits_;
+	}
+
+	/****************************************************************************
+	 ***************************************************************************/
+	size_t getNumMisses() const
+	{
+		lock_guard<mutex> lock(mutex_);
+		return misses_;
+	}
+};
+
+/**############################################################################
+# END OF FILE
+#############################################################################*/
+
+#endif /* __DATASETCACHE_H ****************************************************/
@@ -0,0 +1,359 @@
+/**############################################################################
+#
+# Description: Catalog of the data files of a data directory
+#
+#
+# Copyright (C) 2024 by Hristina Radak
+#
+# Email: hristinaradak95@gmail.com
+#
+###############################################################################
+# Scanning a data directory once stores for any data file its number of
+# samples, its channels with the position, number and range of their values
+# and a checksum of its content in a single catalog file. Runs take the
+# number of samples and the channel positions from the catalog instead of
+# searching the data files, and missing channels or short files are reported
+# before any fusion has run. An entry is used only as long as its data file
+# has got the size and modification time recorded. The checksum is
+# informational only, e.g. to compare the catalogs of two directories, it is
+# not verified by a run as that would read any data file in whole.
+#############################################################################*/
+
+#ifndef __DATASETCATALOG_H
+#define __DATASETCATALOG_H
+
+/**############################################################################
+# INCLUDES
+#############################################################################*/
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <valarray>
+#include <vector>
+
+#include "../../io/iobinarydatafile.h"
+#include "../../io/ioconfigfile.h"
+#include "../../io/iomappeddatafile.h"
+
+/**############################################################################
+# NAMES
+#############################################################################*/
+
+using namespace std;
+
+/**############################################################################
+# DEFINES
+#############################################################################*/
+
+/******************************************************************************
+ * the name of the catalog file within a data directory, it has not got the
+ * suffix of the configuration files next to it, thus a pattern of those
+ * does not take it for one
+ *****************************************************************************/
+const string CATALOG_FILE_NAME = "catalog.idx";
+
+/**############################################################################
+# CLASS DECLARATIONS
+#############################################################################*/
+
+/******************************************************************************
+ *****************************************************************************/
+class DatasetCatalog {
+public:
+	/****************************************************************************
+	 * the catalog entry of a data file, the positions of its keys are given
+	 * for text data files only
+	 ***************************************************************************/
+	struct Entry {
+		unsigned long numSamples = 0;
+		unsigned long fileSize = 0;
+		long fileTime = 0;
+
+		/** recorded by @ref scan only, never compared to the data file *******/
+		unsigned long checksum = 0;
+
+		vector<IoMappedDataFile::KeyPosition> keys;
+
+		/** the key of a section, NULL if missing *****************************/
+		const IoMappedDataFile::KeyPosition *find(const string &section,
+				const string &key) const
+		{
+			for (const IoMappedDataFile::KeyPosition &keyPosition : keys) {
+				if (keyPosition.section == section && keyPosition.key == key) {
+					return &keyPosition;
+				}
+			}
+			return NULL;
+		}
+	};
+
+private:
+	/** the directory cataloged ************************************************/
+	string dirName_;
+
+	/** the entries by data file name ******************************************/
+	map<string, Entry> entries_;
+
+	/****************************************************************************
+	 * 64 bit FNV-1a hash of the content of a file
+	 ***************************************************************************/
+	static unsigned long getChecksum(const string &fileName)
+	{
+		ifstream file(fileName.c_str(), ios::in | ios::binary);
+		vector<char> block(1 << 20);
+		uint64_t hash = 14695981039346656037ULL;
+
+		if (!file.is_open()) {
+			cerr << "ERROR : COULD_NOT_OPEN_FILE : ";
+			cerr << "file = " << '"' << fileName << '"' << " : ";
+			cerr << "DatasetCatalog::getChecksum" << endl;
+			throw IoFileExcept(ERROR_COULD_NOT_OPEN_FILE);
+		}
+		while (file.read(block.data(), block.size()) || file.gcount() > 0) {
+			for (streamsize i = 0; i < file.gcount(); i++) {
+				hash ^= static_cast<unsigned char>(block[i]);
+				hash *= 1099511628211ULL;
+			}
+		}
+		return hash;
+	}
+
+	/****************************************************************************
+	 ***************************************************************************/
+	static long getFileTime(const string &fileName)
+	{
+		return filesystem::last_write_time(fileName).time_since_epoch().count();
+	}
+
+	/****************************************************************************
+	 * scan a single data file, reading all of its values once
+	 ***************************************************************************/
+	static Entry scanFile(const string &fileName)
+	{
+		Entry entry;
+		entry.fileSize = filesystem::file_size(fileName);
+		entry.fileTime = getFileTime(fileName);
+		entry.checksum = getChecksum(fileName);
+
+		if (isBinaryDataFile(fileName)) {
+			IoBinaryDataFile file(fileName);
+			vector<string> sections, keys;
+			valarray<double> values;
+			entry.numSamples = file.getNumSamples();
+			file.getKeys(sections, keys);
+			for (size_t k = 0; k < keys.size(); k++) {
+				IoMappedDataFile::KeyPosition keyPosition = {sections[k], keys[k],
+						0, 0, entry.numSamples, 0.0, 0.0};
+				if (entry.numSamples > 0) {
+					file.getValues(values, keys[k], sections[k], entry.numSamples);
+					keyPosition.minimum = values.min();
+					keyPosition.maximum = values.max();
+				}
+				entry.keys.push_back(keyPosition);
+			}
+			return entry;
+		}
+
+		IoMappedDataFile file(fileName);
+		file.scanKeys(entry.keys);
+		file.getValue(entry.numSamples, "numSamples", "GLOBAL_DATA");
+		return entry;
+	}
+
+public:
+	/****************************************************************************
+	 ***************************************************************************/
+	DatasetCatalog()
+	{
+	}
+
+	/****************************************************************************
+	 * scan all text and binary data files of a directory and save the
+	 * catalog file next to them
+	 ***************************************************************************/
+	void scan(const string &dirName)
+	{
+		try {
+			dirName_ = dirName;
+			entries_.clear();
+			for (const filesystem::directory_entry &file
+					: filesystem::directory_iterator(dirName)) {
+				string name = file.path().filename().string();
+				if (file.is_regular_file() && (isBinaryDataFile(name)
+						|| file.path().extension() == ".dat")) {
+					entries_[name] = scanFile(file.path().string());
+				}
+			}
+			save();
+		}
+		catch (filesystem::filesystem_error &e) {
+			cerr << "ERROR : " << e.what() << " : ";
+			cerr << "DatasetCatalog::scan" << endl;
+			throw;
+		}
+		catch (...) {
+			cerr << "ERROR : UNKNOWN : ";
+			cerr << "dir = " << '"' << dirName << '"' << " : ";
+			cerr << "DatasetCatalog::scan" << endl;
+			throw;
+		}
+	}
+
+	/****************************************************************************
+	 * write the catalog file of the directory scanned, any data file is a
+	 * section of its own
+	 ***************************************************************************/
+	void save() const
+	{
+		IoConfigFile catalog;
+		for (const pair<const string, Entry> &p_entry : entries_) {
+			const string &section = p_entry.first;
+			const Entry &entry = p_entry.second;
+			size_t numKeys = entry.keys.size();
+			valarray<string> channels(numKeys);
+			valarray<unsigned long> positions(numKeys), lineNumbers(numKeys),
+					numValues(numKeys);
+			valarray<double> minimum(numKeys), maximum(numKeys);
+			for (size_t k = 0; k < numKeys; k++) {
+				channels[k] = entry.keys[k].section + CHANNEL_SEPARATOR
+						+ entry.keys[k].key;
+				positions[k] = entry.keys[k].position;
+				lineNumbers[k] = entry.keys[k].lineNumber;
+				numValues[k] = entry.keys[k].numValues;
+				minimum[k] = entry.keys[k].minimum;
+				maximum[k] = entry.keys[k].maximum;
+			}
+			catalog.setValue(entry.numSamples, "numSamples", section);
+			catalog.setValue(entry.fileSize, "fileSize", section);
+			catalog.setValue(entry.fileTime, "fileTime", section);
+			catalog.setValue(entry.checksum, "checksum", section);
+			if (numKeys > 0) {
+				catalog.setValues(channels, "channels", section);
+				catalog.setValues(positions, "positions", section);
+				catalog.setValues(lineNumbers, "lineNumbers", section);
+				catalog.setValues(numValues, "numValues", section);
+				catalog.setValues(minimum, "minimum", section);
+				catalog.setValues(maximum, "maximum", section);
+			}
+		}
+		catalog.setFileName((filesystem::path(dirName_) / CATALOG_FILE_NAME).string());
+		catalog.saveFile();
+	}
+
+	/****************************************************************************
+	 * load the catalog file of a directory, false if there is none
+	 ***************************************************************************/
+	bool load(const string &dirName)
+	{
+		string fileName = (filesystem::path(dirName) / CATALOG_FILE_NAME).string();
+		dirName_ = dirName;
+		entries_.clear();
+		if (!filesystem::exists(fileName)) {
+			return false;
+		}
+
+		IoConfigFile catalog;
+		vector<string> files;
+		try {
+			catalog.loadFile(fileName, false);
+			catalog.getSections(files);
+			for (size_t i = 0; i < files.size(); i++) {
+				Entry &entry = entries_[files[i]];
+				const string &section = files[i];
+				catalog.getValue(entry.numSamples, "numSamples", section);
+				catalog.getValue(entry.fileSize, "fileSize", section);
+				catalog.getValue(entry.fileTime, "fileTime", section);
+				catalog.getValue(entry.checksum, "checksum", section);
+				if (!catalog.keyExists("channels", section)) {
+					continue;
+				}
+				valarray<string> channels;
+				valarray<unsigned long> positions, lineNumbers, numValues;
+				valarray<double> minimum, maximum;
+				catalog.getValues(channels, "channels", section);
+				catalog.getValues(positions, "positions", section, channels.size());
+				catalog.getValues(lineNumbers, "lineNumbers", section, channels.size());
+				catalog.getValues(numValues, "numValues", section, channels.size());
+				catalog.getValues(minimum, "minimum", section, channels.size());
+				catalog.getValues(maximum, "maximum", section, channels.size());
+				for (size_t k = 0; k < channels.size(); k++) {
+					size_t separator = channels[k].find(CHANNEL_SEPARATOR);
+					entry.keys.push_back({channels[k].substr(0, separator),
+							channels[k].substr(separator + CHANNEL_SEPARATOR.size()),
+							positions[k], lineNumbers[k], numValues[k],
+							minimum[k], maximum[k]});
+				}
+			}
+			return true;
+		}
+		catch (...) {
+			cerr << "ERROR : UNKNOWN : ";
+			cerr << "file = " << '"' << fileName << '"' << " : ";
+			cerr << "DatasetCatalog::load" << endl;
+			entries_.clear();
+			throw;
+		}
+	}
+
+	/****************************************************************************
+	 * the entry of a data file of the directory cataloged, NULL if there is
+	 * none or the file has changed since it was scanned
+	 ***************************************************************************/
+	const Entry *find(const string &fileName) const
+	{
+		filesystem::path path(fileName);
+		auto p_entry = entries_.find(path.filename().string());
+		if (p_entry == entries_.end()
+				|| !filesystem::equivalent(path.parent_path().empty()
+						? filesystem::path(".") : path.parent_path(),
+						dirName_.empty() ? filesystem::path(".")
+						: filesystem::path(dirName_))) {
+			return NULL;
+		}
+		error_code error;
+		uintmax_t fileSize = filesystem::file_size(path, error);
+		if (error || fileSize != p_entry->second.fileSize
+				|| getFileTime(fileName) != p_entry->second.fileTime) {
+			return NULL;
+		}
+		return &p_entry->second;
+	}
+
+	/****************************************************************************
+	 * check that a data file holds the keys of a section with at least
+	 * numSamples values each, the same errors reading them would give are
+	 * thrown
+	 ***************************************************************************/
+	static void check(const Entry &entry, const string &fileName,
+			const string &section, const vector<string> &keys,
+			const unsigned long numSamples)
+	{
+		for (const string &key : keys) {
+			const IoMappedDataFile::KeyPosition *p_key = entry.find(section, key);
+			if (p_key == NULL) {
+				cerr << "ERROR : KEY_NOT_FOUND : ";
+				cerr << "section = " << section << " : key = " << key << " : ";
+				cerr << "file = " << '"' << fileName << '"' << " : ";
+				cerr << "DatasetCatalog::check" << endl;
+				throw IoDataFileExcept(ERROR_KEY_NOT_FOUND);
+			}
+			if (p_key->numValues < numSamples) {
+				cerr << "ERROR : NOT_ENOUGH_VALUES : ";
+				cerr << "section = " << section << " : key = " << key << " : ";
+				cerr << "file = " << '"' << fileName << '"' << " : ";
+				cerr << "DatasetCatalog::check" << endl;
+				throw IoDataFileExcept(ERROR_NOT_ENOUGH_VALUES);
+			}
+		}
+	}
+};
+
+/**############################################################################
+# END OF FILE
+#############################################################################*/
+
+#endif /* __DATASETCATALOG_H **************************************************/
@@ -0,0 +1,181 @@
+/**############################################################################
+#
+# Description: Decimation of the samples written to the result files
+#
+#
+# Copyright (C) 2024 by Hristina Radak
+#
+# Email: hristinaradak95@gmail.com
+#
+###############################################################################
+# Which rows of a run are written is set in the configuration file, all of
+# them if none of the keys is given:
+#
+#   OutputDecimation = 10    keep every 10th sample only
+#   OutputWindow = {0, 20}   keep all samples from 0 s up to 20 s, decimate
+#                            the ones before and after, or drop them if no
+#                            OutputDecimation is given
+#   OutputEnvelope = yes     instead of every 10th sample keep the minimum
+#                            and the maximum of any column over each block
+#                            of 10 samples, as two rows
+#
+# Row r of a run, i.e. sample r + 1, is taken at r * OUTPUT_SAMPLE_TIME
+# seconds. Once rows are left out, the time of any row written is appended
+# to it as a column of its own in the CSV files, both rows of an envelope
+# are taken at the start of its block. The result store keeps the times of
+# the rows of any dataset in a block of their own in any case, see
+# resultstore.hpp. euler_analysis.py and resultstore.py take the times from
+# there, the analysis of --convergence and --summary is not decimated.
+#############################################################################*/
+
+#ifndef __DECIMATION_H
+#define __DECIMATION_H
+
+/**############################################################################
+# INCLUDES
+#############################################################################*/
+
+#include <algorithm>
+#include <cmath>
+
+/**############################################################################
+# NAMES
+#############################################################################*/
+
+using namespace std;
+
+/**############################################################################
+# DEFINES
+#############################################################################*/
+
+/******************************************************************************
+ * the time between two samples in seconds
+ *****************************************************************************/
+const double OUTPUT_SAMPLE_TIME = 0.01;
+
+/**############################################################################
+# CLASS DECLARATIONS
+#############################################################################*/
+
+/******************************************************************************
+ *****************************************************************************/
+class OutputDecimation {
+
+	/** the decimation factor outside the window, 1 keeps all rows, 0 none ****/
+	unsigned long every_ = 1;
+
+	/** the first and the last row of the window kept dense, none if the first
+	 * is beyond the last *****************************************************/
+	unsigned long windowFirst_ = 1;
+	unsigned long windowLast_ = 0;
+
+	/** the minimum and maximum of any block are kept instead of a sample ******/
+	bool envelope_ = false;
+
+public:
+	/****************************************************************************
+	 * the action taken on a row: written as it is, dropped, or added to the
+	 * envelope of its block
+	 ***************************************************************************/
+	enum Action {KEEP, DROP, ENVELOPE};
+
+	/****************************************************************************
+	 ***************************************************************************/
+	OutputDecimation()
+	{
+	}
+
+	/****************************************************************************
+	 * decimate by every outside the window from begin to end seconds, no
+	 * window is kept if end is less than begin. every = 0 drops all rows
+	 * outside the window, and keeps all of them if there is none.
+	 ***************************************************************************/
+	OutputDecimation(const unsigned long every, const double begin,
+			const double end, const bool envelope)
+	: every_(every), envelope_(envelope)
+	{
+		if (end >= begin && end >= 0) {
+			windowFirst_ = (unsigned long) ceil(max(begin, 0.0) / OUTPUT_SAMPLE_TIME - 1e-9);
+			windowLast_ = (unsigned long) floor(end / OUTPUT_SAMPLE_TIME + 1e-9);
+		}
+		else if (every_ == 0) {
+			every_ = 1;
+		}
+	}
+
+	/****************************************************************************
+	 * true if every row is written
+	 ***************************************************************************/
+	bool keepsAll() const
+	{
+		return every_ == 1;
+	}
+
+	/****************************************************************************
+	 * the time of a row in seconds
+	 ***************************************************************************/
+	static double getTime(const unsigned long row)
+	{
+		return row * OUTPUT_SAMPLE_TIME;
+	}
+
+	/****************************************************************************
+	 * the block of a row outside the window, two rows are of the same block if
+	 * they are decimated into the same envelope
+	 ***************************************************************************/
+	unsigned long getBlock(const unsigned long row) const
+	{
+		return row / every_;
+	}
+
+	/****************************************************************************
+	 ***************************************************************************/
+	Action getAction(const unsigned long row) const
+	{
+		if (every_ == 1 || (row >= windowFirst_ && row <= windowLast_)) {
+			return KEEP;
+		}
+		if (every_ == 0) {
+			return DROP;
+		}
+		if (envelope_) {
+			return ENVELOPE;
+		}
+		return (row % every_ == 0) ? KEEP : DROP;
+	}
+
+	/****************************************************************************
+	 * the number of rows written of a run of numRows rows, an envelope takes
+	 * two rows
+	 ***************************************************************************/
+	unsigned long getNumRows(const unsigned long numRows) const
+	{
+		unsigned long result = 0;
+		bool open = false;
+		unsigned long block = 0;
+		for (unsigned long row = 0; row < numRows; row++) {
+			Action action = getAction(row);
+			if (action == ENVELOPE && open && getBlock(row) == block) {
+				continue;
+			}
+			if (open) {
+				result += 2;
+				open = false;
+			}
+			if (action == ENVELOPE) {
+				open = true;
+				block = getBlock(row);
+			}
+			else if (action == KEEP) {
+				result++;
+			}
+		}
+		return result + (open ? 2 : 0);
+	}
+};
+
+/**############################################################################
+# END OF FILE
+#############################################################################*/
+
+#endif /* __DECIMATION_H ******************************************************/
@@ -0,0 +1,163 @@
+/**############################################################################
+#
+# Description: Streaming error statistics of an orientation estimate
+#
+#
+# Copyright (C) 2024 by Hristina Radak
+#
+# Email: hristinaradak95@gmail.com
+#
+###############################################################################
+# The error of any sample of an estimate against the true orientation is
+# added as it comes, thus a whole run is summarized without keeping any of
+# its samples: the angle of the rotation between estimate and truth (mean,
+# RMS, maximum and the one of the last sample) and the RMSE of roll, pitch
+# and yaw. All angles are in degrees, the Euler angles are derived the way
+# runFusions does and their errors are wrapped to [-180, 180).
+#############################################################################*/
+
+#ifndef __ERRORSTATS_H
+#define __ERRORSTATS_H
+
+/**############################################################################
+# INCLUDES
+#############################################################################*/
+
+#include <algorithm>
+#include <cmath>
+
+/**############################################################################
+# NAMES
+#############################################################################*/
+
+using namespace std;
+
+/**############################################################################
+# CLASS DECLARATIONS
+#############################################################################*/
+
+/******************************************************************************
+ *****************************************************************************/
+class ErrorStats {
+
+	/** the number of samples added ********************************************/
+	unsigned long numSamples_ = 0;
+
+	/** sums of the angular error and its square, its maximum and last value **/
+	double sumError_ = 0.0;
+	double sumSquaredError_ = 0.0;
+	double maxError_ = 0.0;
+	double finalError_ = 0.0;
+
+	/** sums of the squared errors of roll, pitch and yaw **********************/
+	double sumSquaredEuler_[3] = {0.0, 0.0, 0.0};
+
+public:
+	/****************************************************************************
+	 * the angle in degrees of the rotation between two unit quaternions
+	 * {s, v1, v2, v3}, in [0, 180]
+	 ***************************************************************************/
+	static double getAngularError(const double *quat, const double *trueQuat)
+	{
+		/** the relative rotation conj(trueQuat) * quat **************************/
+		double s = trueQuat[0] * quat[0] + trueQuat[1] * quat[1]
+				+ trueQuat[2] * quat[2] + trueQuat[3] * quat[3];
+		double x = trueQuat[0] * quat[1] - quat[0] * trueQuat[1]
+				- (trueQuat[2] * quat[3] - trueQuat[3] * quat[2]);
+		double y = trueQuat[0] * quat[2] - quat[0] * trueQuat[2]
+				- (trueQuat[3] * quat[1] - trueQuat[1] * quat[3]);
+		double z = trueQuat[0] * quat[3] - quat[0] * trueQuat[3]
+				- (trueQuat[1] * quat[2] - trueQuat[2] * quat[1]);
+		return 2 * atan2(sqrt(x * x + y * y + z * z), fabs(s)) * 180 / M_PI;
+	}
+
+	/****************************************************************************
+	 * roll, pitch and yaw in degrees of the conjugate of a quaternion, the
+	 * same as Quaternion::to_EulerAngles of the conjugate
+	 ***************************************************************************/
+	static void getEulerAngles(const double *quat, double *angles)
+	{
+		double s = quat[0], v1 = quat[1], v2 = quat[2], v3 = quat[3];
+		angles[0] = atan2(v2 * v3 + s * v1, s * s - 0.5 + v3 * v3) * 180 / M_PI;
+		angles[1] = -asin(2 * (v1 * v3 - s * v2)) * 180 / M_PI;
+		angles[2] = atan2(v1 * v2 + s * v3, s * s - 0.5 + v1 * v1) * 180 / M_PI;
+	}
+
+	/****************************************************************************
+	 ***************************************************************************/
+	ErrorStats()
+	{
+	}
+
+	/****************************************************************************
+	 * add the error of the next sample, the Euler angles of the truth are
+	 * passed in as they are the same for all estimates of a sample
+	 ***************************************************************************/
+	void add(const double *quat, const double *trueQuat,
+			const double *trueAngles)
+	{
+		double error = getAngularError(quat, trueQuat);
+		double angles[3];
+
+		numSamples_++;
+		sumError_ += error;
+		sumSquaredError_ += error * error;
+		maxError_ = max(maxError_, error);
+		finalError_ = error;
+
+		getEulerAngles(quat, angles);
+		for (unsigned k = 0; k < 3; k++) {
+			double difference = remainder(angles[k] - trueAngles[k], 360.0);
+			sumSquaredEuler_[k] += difference * difference;
+		}
+	}
+
+	/****************************************************************************
+	 ***************************************************************************/
+	unsigned long getNumSamples() const
+	{
+		return numSamples_;
+	}
+
+	/****************************************************************************
+	 ***************************************************************************/
+	double getMeanError() const
+	{
+		return (numSamples_ > 0) ? sumError_ / numSamples_ : 0.0;
+	}
+
+	/****************************************************************************
+	 ***************************************************************************/
+	double getRmsError() const
+	{
+		return (numSamples_ > 0) ? sqrt(sumSquaredError_ / numSamples_) : 0.0;
+	}
+
+	/****************************************************************************
+	 ***************************************************************************/
+	double getMaxError() const
+	{
+		return maxError_;
+	}
+
+	/****************************************************************************
+	 ***************************************************************************/
+	double getFinalError() const
+	{
+		return finalError_;
+	}
+
+	/****************************************************************************
+	 * the RMSE of roll (0), pitch (1) or yaw (2)
+	 ***************************************************************************/
+	double getEulerRmse(const unsigned axis) const
+	{
+		return (numSamples_ > 0) ? sqrt(sumSquaredEuler_[axis] / numSamples_) : 0.0;
+	}
+};
+
+/**############################################################################
+# END OF FILE
+#############################################################################*/
+
+#endif /* __ERRORSTATS_H ******************************************************/
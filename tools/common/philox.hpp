@@ -0,0 +1,115 @@
+/**############################################################################
+#
+# Description: Counter-based random numbers of the Philox4x32-10 generator
+#
+#
+# Copyright (C) 2024 by Hristina Radak
+#
+# Email: hristinaradak95@gmail.com
+#
+###############################################################################
+# Philox (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3", 2011)
+# has no state: a block of four random words is a function of a counter and
+# a key only. Keyed by a dataset and counted by beta index and trial, the
+# random numbers of any run of a sweep are the same whichever thread draws
+# them and in whichever order, and no generator is shared between threads.
+#############################################################################*/
+
+#ifndef __PHILOX_H
+#define __PHILOX_H
+
+/**############################################################################
+# INCLUDES
+#############################################################################*/
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+/**############################################################################
+# NAMES
+#############################################################################*/
+
+using namespace std;
+
+/**############################################################################
+# CLASS DECLARATIONS
+#############################################################################*/
+
+/******************************************************************************
+ *****************************************************************************/
+class Philox {
+
+	/** the multipliers and the key increments of the rounds ******************/
+	static const uint32_t M0 = 0xD2511F53;
+	static const uint32_t M1 = 0xCD9E8D57;
+	static const uint32_t W0 = 0x9E3779B9;
+	static const uint32_t W1 = 0xBB67AE85;
+
+	static const unsigned NUM_ROUNDS = 10;
+
+	/** the key of the stream **************************************************/
+	array<uint32_t, 2> key_;
+
+	/****************************************************************************
+	 ***************************************************************************/
+	static void round(array<uint32_t, 4> &counter, const array<uint32_t, 2> &key)
+	{
+		uint64_t product0 = (uint64_t) M0 * counter[0];
+		uint64_t product1 = (uint64_t) M1 * counter[2];
+		counter = {(uint32_t) (product1 >> 32) ^ counter[1] ^ key[0],
+				(uint32_t) product1,
+				(uint32_t) (product0 >> 32) ^ counter[3] ^ key[1],
+				(uint32_t) product0};
+	}
+
+public:
+	/****************************************************************************
+	 ***************************************************************************/
+	Philox(const uint32_t key0 = 0, const uint32_t key1 = 0)
+	: key_({key0, key1})
+	{
+	}
+
+	/****************************************************************************
+	 * the stream keyed by a name, e.g. of a dataset, by its FNV-1a hash
+	 ***************************************************************************/
+	Philox(const string &name)
+	{
+		uint64_t hash = 0xCBF29CE484222325;
+		for (unsigned char c : name) {
+			hash = (hash ^ c) * 0x100000001B3;
+		}
+		key_ = {(uint32_t) hash, (uint32_t) (hash >> 32)};
+	}
+
+	/****************************************************************************
+	 * the block of four random words of counter
+	 ***************************************************************************/
+	array<uint32_t, 4> operator()(array<uint32_t, 4> counter) const
+	{
+		array<uint32_t, 2> key = key_;
+		for (unsigned r = 0; r < NUM_ROUNDS; r++) {
+			if (r > 0) {
+				key[0] += W0;
+				key[1] += W1;
+			}
+			round(counter, key);
+		}
+		return counter;
+	}
+
+	/****************************************************************************
+	 * a random word as a uniform random number in [0, 1)
+	 ***************************************************************************/
+	static double toUniform(const uint32_t word)
+	{
+		return word * (1.0 / 4294967296.0);
+	}
+};
+
+/**############################################################################
+# END OF FILE
+#############################################################################*/
+
+#endif /* __PHILOX_H **********************************************************/
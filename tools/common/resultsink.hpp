@@ -0,0 +1,571 @@
+/**############################################################################
+#
+# Description: Writing the results of a beta sweep on a dedicated thread
+#
+#
+# Copyright (C) 2024 by Hristina Radak
+#
+# Email: hristinaradak95@gmail.com
+#
+###############################################################################
+# The fusion thread hands fixed size result records to a single producer
+# single consumer ring buffer. An I/O thread takes them out, formats them and
+# appends them to the quaternion and Euler angle result files of their beta
+# value, or to the result store of the sweep, or only updates the error
+# statistics of any beta value and algorithm that are written to a summary
+# file once the run is complete. Besides, the convergence times of all beta
+# values may be found on the way. The rows written to the files or the store
+# may be decimated, see decimation.hpp, the time of any row is written along
+# with it then. If the ring is full, the fusion thread waits for the I/O thread to
+# free a slot, thus no record is ever dropped and the memory used is bounded
+# by the size of the ring. An error of the I/O thread stops it, the records
+# pushed after are dropped and the error is rethrown on closing the sink.
+# A sink aborted, e.g. as its run has failed, discards the records left and
+# writes neither the summary nor the convergence times.
+#############################################################################*/
+
+#ifndef __RESULTSINK_H
+#define __RESULTSINK_H
+
+/**############################################################################
+# INCLUDES
+#############################################################################*/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "convergence.hpp"
+#include "csv_writer.hpp"
+#include "decimation.hpp"
+#include "errorstats.hpp"
+#include "resultstore.hpp"
+
+/**############################################################################
+# NAMES
+#############################################################################*/
+
+using namespace std;
+
+/**############################################################################
+# CLASS DECLARATIONS
+#############################################################################*/
+
+/******************************************************************************
+ * The results of a single sample of a single beta value: the true, Madgwick,
+ * Wilson and QGD quaternions as {s, v1, v2, v3} each and their Euler angles
+ * in degrees in the same order.
+ *****************************************************************************/
+struct ResultRecord {
+	uint32_t beta;
+	uint32_t sample;
+	double quat[16];
+	double euler[12];
+};
+
+/******************************************************************************
+ * A lock-free ring buffer of a fixed number of slots, rounded up to a power
+ * of two, for exactly one producer thread and one consumer thread.
+ *****************************************************************************/
+template<class T> class SpscRing {
+
+	/** the slots, one of them is always left free *****************************/
+	vector<T> slots_;
+	size_t mask_;
+
+	/** the next slot to write respectively to read, each one is changed by
+	 * a single thread only and kept on a cache line of its own **************/
+	alignas(64) atomic<size_t> head_;
+	alignas(64) atomic<size_t> tail_;
+
+public:
+	/****************************************************************************
+	 ***************************************************************************/
+	SpscRing(const size_t capacity)
+	: head_(0), tail_(0)
+	{
+		size_t size = 2;
+		while (size < capacity + 1) {
+			size *= 2;
+		}
+		slots_.resize(size);
+		mask_ = size - 1;
+	}
+
+	/****************************************************************************
+	 * called by the producer only, false if the ring is full
+	 ***************************************************************************/
+	bool tryPush(const T &item)
+	{
+		size_t head = head_.load(memory_order_relaxed);
+		size_t next = (head + 1) & mask_;
+		if (next == tail_.load(memory_order_acquire)) {
+			return false;
+		}
+		slots_[head] = item;
+		head_.store(next, memory_order_release);
+		return true;
+	}
+
+	/****************************************************************************
+	 * called by the consumer only, false if the ring is empty
+	 ***************************************************************************/
+	bool tryPop(T &item)
+	{
+		size_t tail = tail_.load(memory_order_relaxed);
+		if (tail == head_.load(memory_order_acquire)) {
+			return false;
+		}
+		item = slots_[tail];
+		tail_.store((tail + 1) & mask_, memory_order_release);
+		return true;
+	}
+};
+
+/******************************************************************************
+ * Writes the result records of a beta sweep to the result files of each beta
+ * value on a thread of its own. The files are identical to the ones written
+ * on the fusion thread.
+ *****************************************************************************/
+class ResultSink {
+
+	/** the records not written yet ********************************************/
+	SpscRing<ResultRecord> ring_;
+
+	/** the result files and the beta values by beta index ********************/
+	vector<CsvWriter> quatFiles_, eulerFiles_;
+	vector<double> betas_;
+
+	/** the result store written instead of the files, if any, and the
+	 * dataset written to *****************************************************/
+	ResultStore *store_ = NULL;
+	size_t storeDataset_ = 0;
+
+	/** the summary file written instead of the files, if any, the dataset
+	 * summarized and the statistics of Madgwick, Wilson and QGD by beta
+	 * index ******************************************************************/
+	CsvWriter *summary_ = NULL;
+	string dataset_;
+	vector<ErrorStats> stats_;
+
+	/** the writer of the convergence times if they are analyzed, the name of
+	 * their files and the analysis of any beta value ************************/
+	const ConvergenceWriter *convergence_ = NULL;
+	string convergenceName_;
+	vector<ConvergenceAnalyzer> analyzers_;
+
+	/** the decimation of the rows written, and by beta index the number of
+	 * rows received and written, the sample of the first row and the
+	 * envelope of the current block and its time *****************************/
+	OutputDecimation decimation_;
+	vector<unsigned long> numRowsIn_, numRowsOut_;
+	vector<uint32_t> firstSample_;
+	struct Envelope {
+		ResultRecord minimum, maximum;
+		double time;
+		unsigned long block;
+		bool open;
+	};
+	vector<Envelope> envelopes_;
+
+	/** the I/O thread and the flags telling it to finish respectively to
+	 * discard the records left *********************************************/
+	thread worker_;
+	atomic<bool> stop_, abort_;
+
+	/** the error the I/O thread has stopped on, if any ************************/
+	exception_ptr error_;
+	atomic<bool> failed_;
+
+	/** number of records the producer had to wait for a free slot *************/
+	size_t numStalls_ = 0;
+
+	/****************************************************************************
+	 * back off after the ring has been found full respectively empty several
+	 * times, first yielding then sleeping
+	 ***************************************************************************/
+	static void wait(const unsigned attempt)
+	{
+		if (attempt < 64) {
+			this_thread::yield();
+		}
+		else {
+			this_thread::sleep_for(chrono::microseconds(50));
+		}
+	}
+
+	/****************************************************************************
+	 ***************************************************************************/
+	void write(const ResultRecord &record)
+	{
+		if (convergence_ != NULL) {
+			analyzers_[record.beta].add(record.euler);
+		}
+		if (summary_ != NULL) {
+			double trueAngles[3];
+			ErrorStats::getEulerAngles(record.quat, trueAngles);
+			for (unsigned a = 1; a < 4; a++) {
+				stats_[3 * record.beta + a - 1].add(record.quat + 4 * a, record.quat,
+						trueAngles);
+			}
+			return;
+		}
+
+		size_t b = record.beta;
+		unsigned long row = numRowsIn_[b]++;
+		double time = OutputDecimation::getTime(row);
+		if (row == 0) {
+			firstSample_[b] = record.sample;
+		}
+		if (decimation_.keepsAll()) {
+			writeRow(record, record.sample, time);
+			return;
+		}
+		switch (decimation_.getAction(row)) {
+		case OutputDecimation::KEEP:
+			closeEnvelope(b);
+			writeRow(record, firstSample_[b] + numRowsOut_[b]++, time);
+			break;
+		case OutputDecimation::DROP:
+			break;
+		case OutputDecimation::ENVELOPE: {
+			Envelope &envelope = envelopes_[b];
+			if (envelope.open && envelope.block == decimation_.getBlock(row)) {
+				for (unsigned k = 0; k < 16; k++) {
+					envelope.minimum.quat[k] = min(envelope.minimum.quat[k], record.quat[k]);
+					envelope.maximum.quat[k] = max(envelope.maximum.quat[k], record.quat[k]);
+				}
+				for (unsigned k = 0; k < 12; k++) {
+					envelope.minimum.euler[k] = min(envelope.minimum.euler[k], record.euler[k]);
+					envelope.maximum.euler[k] = max(envelope.maximum.euler[k], record.euler[k]);
+				}
+				break;
+			}
+			closeEnvelope(b);
+			envelope.minimum = envelope.maximum = record;
+			envelope.time = time;
+			envelope.block = decimation_.getBlock(row);
+			envelope.open = true;
+			break;
+		}
+		}
+	}
+
+	/****************************************************************************
+	 * write the minimum and the maximum row of the open envelope of a beta
+	 * value, if any
+	 ***************************************************************************/
+	void closeEnvelope(const size_t b)
+	{
+		Envelope &envelope = envelopes_[b];
+		if (!envelope.open) {
+			return;
+		}
+		writeRow(envelope.minimum, firstSample_[b] + numRowsOut_[b]++, envelope.time);
+		writeRow(envelope.maximum, firstSample_[b] + numRowsOut_[b]++, envelope.time);
+		envelope.open = false;
+	}
+
+	/****************************************************************************
+	 * write a record to the files or the store as the given sample, taken at
+	 * time seconds, the CSV files get the time as last column if the rows
+	 * are decimated
+	 ***************************************************************************/
+	void writeRow(const ResultRecord &record, const uint32_t sample,
+			const double time)
+	{
+		if (store_ != NULL) {
+			store_->put(storeDataset_, record.beta, sample, time, record.quat,
+					record.euler);
+			return;
+		}
+		size_t numTimes = decimation_.keepsAll() ? 0 : 1;
+		double beta = betas_[record.beta];
+		double quat[18], euler[14];
+		copy(record.quat, record.quat + 16, quat);
+		copy(record.euler, record.euler + 12, euler);
+		quat[16] = euler[12] = beta;
+		quat[17] = euler[13] = time;
+		quatFiles_[record.beta].writeRow(quat, 17 + numTimes);
+		if (!eulerFiles_.empty()) {
+			eulerFiles_[record.beta].writeRow(euler, 13 + numTimes);
+		}
+	}
+
+	/****************************************************************************
+	 * a row per beta value and algorithm: dataset, algorithm, beta index,
+	 * beta, number of samples, mean, RMS, maximum and final angular error and
+	 * the RMSE of roll, pitch and yaw
+	 ***************************************************************************/
+	void writeSummary()
+	{
+		static const string algorithms[3] = {"madgwick", "wilson", "qgd"};
+		for (size_t b = 0; b < betas_.size(); b++) {
+			for (unsigned a = 0; a < 3; a++) {
+				const ErrorStats &stats = stats_[3 * b + a];
+				summary_->writeField(dataset_);
+				summary_->writeField(algorithms[a]);
+				summary_->writeField(b);
+				summary_->writeField(betas_[b]);
+				summary_->writeField(stats.getNumSamples());
+				summary_->writeRow({stats.getMeanError(),
+						stats.getRmsError(), stats.getMaxError(),
+						stats.getFinalError(), stats.getEulerRmse(0),
+						stats.getEulerRmse(1), stats.getEulerRmse(2)});
+			}
+		}
+		summary_->flush();
+	}
+
+	/****************************************************************************
+	 * write records until told to stop and the ring is drained
+	 ***************************************************************************/
+	void writeAll()
+	{
+		ResultRecord record;
+		unsigned attempt = 0;
+		while (!abort_.load(memory_order_acquire)) {
+			if (ring_.tryPop(record)) {
+				write(record);
+				attempt = 0;
+			}
+			else if (stop_.load(memory_order_acquire)) {
+				/** the producer has stopped before, anything left is visible now */
+				while (ring_.tryPop(record)) {
+					write(record);
+				}
+				break;
+			}
+			else {
+				wait(attempt++);
+			}
+		}
+		if (!abort_.load(memory_order_acquire)) {
+			if (summary_ != NULL) {
+				writeSummary();
+			}
+			else {
+				for (size_t b = 0; b < envelopes_.size(); b++) {
+					closeEnvelope(b);
+				}
+			}
+			if (convergence_ != NULL) {
+				convergence_->write(convergenceName_, analyzers_, betas_);
+			}
+		}
+		for (CsvWriter &file : quatFiles_) {
+			file.close();
+		}
+		for (CsvWriter &file : eulerFiles_) {
+			file.close();
+		}
+	}
+
+	/****************************************************************************
+	 * the I/O thread, an error stops it and is kept for close
+	 ***************************************************************************/
+	void work()
+	{
+		try {
+			writeAll();
+		}
+		catch (...) {
+			error_ = current_exception();
+			failed_.store(true, memory_order_release);
+		}
+	}
+
+	/****************************************************************************
+	 * reset the analysis and start the I/O thread
+	 ***************************************************************************/
+	void start()
+	{
+		analyzers_.assign((convergence_ != NULL) ? betas_.size() : 0,
+				ConvergenceAnalyzer());
+		numRowsIn_.assign(betas_.size(), 0);
+		numRowsOut_.assign(betas_.size(), 0);
+		firstSample_.assign(betas_.size(), 0);
+		envelopes_.assign(betas_.size(), Envelope());
+		stop_.store(false);
+		abort_.store(false);
+		error_ = NULL;
+		failed_.store(false);
+		worker_ = thread(&ResultSink::work, this);
+	}
+
+public:
+	/****************************************************************************
+	 ***************************************************************************/
+	ResultSink(const size_t capacity = 4096)
+	: ring_(capacity), stop_(false), abort_(false), failed_(false)
+	{
+	}
+
+	/****************************************************************************
+	 * a sink not closed is aborted
+	 ***************************************************************************/
+	~ResultSink()
+	{
+		abort();
+	}
+
+	/****************************************************************************
+	 * open the result files of all beta values and start the I/O thread, no
+	 * Euler angles are written if eulerFileNames is empty
+	 ***************************************************************************/
+	void open(const vector<string> &quatFileNames,
+			const vector<string> &eulerFileNames, const vector<double> &betas)
+	{
+		close();
+		store_ = NULL;
+		summary_ = NULL;
+		betas_ = betas;
+		quatFiles_.clear();
+		eulerFiles_.clear();
+		for (size_t k = 0; k < betas_.size(); k++) {
+			quatFiles_.emplace_back();
+			quatFiles_.back().open(quatFileNames[k]);
+			if (!eulerFileNames.empty()) {
+				eulerFiles_.emplace_back();
+				eulerFiles_.back().open(eulerFileNames[k]);
+			}
+		}
+		start();
+	}
+
+	/****************************************************************************
+	 * start the I/O thread writing a dataset to a result store, the dataset
+	 * has to be begun before and ended after closing the sink
+	 ***************************************************************************/
+	void open(ResultStore &store, const size_t dataset,
+			const vector<double> &betas)
+	{
+		close();
+		store_ = &store;
+		storeDataset_ = dataset;
+		summary_ = NULL;
+		betas_ = betas;
+		quatFiles_.clear();
+		eulerFiles_.clear();
+		start();
+	}
+
+	/****************************************************************************
+	 * start the I/O thread summarizing the errors of a dataset, a row per
+	 * beta value and algorithm is appended to summary when the sink is closed
+	 ***************************************************************************/
+	void open(CsvWriter &summary, const string &dataset,
+			const vector<double> &betas)
+	{
+		close();
+		store_ = NULL;
+		summary_ = &summary;
+		dataset_ = dataset;
+		betas_ = betas;
+		stats_.assign(3 * betas.size(), ErrorStats());
+		quatFiles_.clear();
+		eulerFiles_.clear();
+		start();
+	}
+
+	/****************************************************************************
+	 * analyze the convergence of the Euler angles of the records of any beta
+	 * value and write the times to files name.csv when the sink is closed,
+	 * takes effect with the next open, NULL stops the analysis
+	 ***************************************************************************/
+	void setConvergence(const ConvergenceWriter *writer, const string &name)
+	{
+		convergence_ = writer;
+		convergenceName_ = name;
+	}
+
+	/****************************************************************************
+	 * decimate the rows written to the files or the store, takes effect with
+	 * the next open
+	 ***************************************************************************/
+	void setDecimation(const OutputDecimation &decimation)
+	{
+		decimation_ = decimation;
+	}
+
+	/****************************************************************************
+	 * hand a record to the I/O thread, waits while the ring is full. The
+	 * record is dropped if the I/O thread has stopped on an error.
+	 ***************************************************************************/
+	void push(const ResultRecord &record)
+	{
+		if (ring_.tryPush(record)) {
+			return;
+		}
+		numStalls_++;
+		for (unsigned attempt = 0; !ring_.tryPush(record); attempt++) {
+			if (failed_.load(memory_order_acquire)) {
+				return;
+			}
+			wait(attempt);
+		}
+	}
+
+	/****************************************************************************
+	 * write all records pushed so far, close the files and stop the I/O
+	 * thread, the error it has stopped on, if any, is rethrown
+	 ***************************************************************************/
+	void close()
+	{
+		if (worker_.joinable()) {
+			stop_.store(true, memory_order_release);
+			worker_.join();
+		}
+		if (!error_) {
+			return;
+		}
+		exception_ptr error = error_;
+		error_ = NULL;
+		try {
+			rethrow_exception(error);
+		}
+		catch (filesystem::filesystem_error &e) {
+			cerr << "ERROR : " << e.what() << " : ";
+			cerr << "ResultSink::close" << endl;
+			throw;
+		}
+		catch (...) {
+			cerr << "ERROR : UNKNOWN : ";
+			cerr << "ResultSink::close" << endl;
+			throw;
+		}
+	}
+
+	/****************************************************************************
+	 * stop the I/O thread, the records not written yet are discarded and the
+	 * summary, the convergence times and any error are not written
+	 ***************************************************************************/
+	void abort()
+	{
+		if (worker_.joinable()) {
+			abort_.store(true, memory_order_release);
+			stop_.store(true, memory_order_release);
+			worker_.join();
+		}
+		error_ = NULL;
+	}
+
+	/****************************************************************************
+	 ***************************************************************************/
+	size_t getNumStalls() const
+	{
+		return numStalls_;
+	}
+};
+
+/**############################################################################
+# END OF FILE
+#############################################################################*/
+
+#endif /* __RESULTSINK_H ******************************************************/
@@ -0,0 +1,420 @@
+/**############################################################################
+#
+# Description: Single binary file holding the results of a whole sweep
+#
+#
+# Copyright (C) 2024 by Hristina Radak
+#
+# Email: hristinaradak95@gmail.com
+#
+###############################################################################
+# Instead of a quaternion and an Euler angle CSV file per dataset and beta
+# value, all results of a sweep go to a single file. Any dataset, beta value
+# and algorithm (true, Madgwick, Wilson, QGD) gets a block of 7 contiguous
+# float64 columns: s, v1, v2, v3, roll, pitch and yaw, or of the 4 quaternion
+# columns only if the Euler angles are left to the reader. The blocks of a
+# dataset are reserved when it starts, thus results can be written in any
+# order of samples and beta values, and several datasets may be written at
+# the same time from different threads. The true orientation does not depend on
+# beta, thus it is stored once per dataset and the index entries of the true
+# algorithm of all beta values refer to the same block. So do the times of
+# the rows, which differ from row * 0.01 s once the rows are decimated (see
+# decimation.hpp): they are stored in a block of a single column per dataset.
+# An index table of all blocks is appended when the file is closed.
+#
+# Layout (host byte order, little endian on any supported machine):
+#   header  64 bytes   magic "QGDRES01", version, entry size, number of
+#                      columns per block, offset and number of index entries
+#   blocks             numColumns x numRows float64 each, column by column,
+#                      the time block numRows float64 (version 2 and later)
+#   index   64 bytes per block, see ResultStore::Entry
+#
+# Python/resultstore.py joins the true block with the blocks of any beta
+# value on reading and maps the index and the columns with numpy.memmap.
+#############################################################################*/
+
+#ifndef __RESULTSTORE_H
+#define __RESULTSTORE_H
+
+/**############################################################################
+# INCLUDES
+#############################################################################*/
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "../../io/iobinarydatafile.h"
+#include "../../io/iofile.h"
+#include "csv_writer.hpp"
+
+/**############################################################################
+# NAMES
+#############################################################################*/
+
+using namespace std;
+
+/**############################################################################
+# DEFINES
+#############################################################################*/
+
+/******************************************************************************
+ * the algorithms stored for any beta value, in the order of their blocks
+ *****************************************************************************/
+const unsigned RESULT_STORE_NUM_ALGORITHMS = 4;
+const unsigned RESULT_STORE_TRUE = 0;
+
+/******************************************************************************
+ * the algorithm of the index entry of the times of the rows of a dataset
+ *****************************************************************************/
+const unsigned RESULT_STORE_TIME = RESULT_STORE_NUM_ALGORITHMS;
+
+/******************************************************************************
+ * the columns of a block: the quaternion and the Euler angles in degrees
+ *****************************************************************************/
+const unsigned RESULT_STORE_NUM_COLUMNS = 7;
+const unsigned RESULT_STORE_NUM_QUAT_COLUMNS = 4;
+
+/******************************************************************************
+ *****************************************************************************/
+const char RESULT_STORE_MAGIC[8] = {'Q', 'G', 'D', 'R', 'E', 'S', '0', '1'};
+const uint32_t RESULT_STORE_VERSION = 2;
+
+/******************************************************************************
+ * the number of rows of any beta value collected before they are written
+ *****************************************************************************/
+const unsigned long RESULT_STORE_TILE_ROWS = 1024;
+
+/**############################################################################
+# CLASS DECLARATIONS
+#############################################################################*/
+
+/******************************************************************************
+ *****************************************************************************/
+class ResultStore {
+public:
+	/****************************************************************************
+	 * the index entry of a block, column c of it starts at byte
+	 * offset + c * numRows * 8, the entries of the true algorithm of a
+	 * dataset share a single block. The beta value is rounded the way the
+	 * result CSV files hold it, thus both label the beta values alike.
+	 ***************************************************************************/
+	struct Entry {
+		char dataset[32];
+		double beta;
+		uint32_t betaIndex;
+		uint32_t algorithm;
+		uint64_t numRows;
+		uint64_t offset;
+	};
+
+	/****************************************************************************
+	 ***************************************************************************/
+	struct Header {
+		char magic[8];
+		uint32_t version;
+		uint32_t entrySize;
+		uint64_t numColumns;
+		uint64_t indexOffset;
+		uint64_t numEntries;
+		char reserved[24];
+	};
+
+private:
+	/** the file and its name **************************************************/
+	fstream file_;
+	string fileName_;
+
+	/** the blocks of all datasets so far ************************************/
+	vector<Entry> index_;
+
+	/** the number of columns of any block ************************************/
+	unsigned numColumns_ = RESULT_STORE_NUM_COLUMNS;
+
+	/** the end of the last block reserved *************************************/
+	uint64_t end_ = sizeof(Header);
+
+	/****************************************************************************
+	 * a dataset begun and not ended yet: its first block and the one of its
+	 * times, the sample stored in row 0, the number of rows, and the rows
+	 * collected of any beta value, column by column, starting at row
+	 * tileFirst, the times along with beta value 0
+	 ***************************************************************************/
+	struct OpenDataset {
+		size_t firstEntry;
+		size_t timeEntry;
+		unsigned long firstSample;
+		unsigned long numRows;
+		vector<vector<double>> tiles;
+		vector<unsigned long> tileFirst, tileSize;
+	};
+
+	/** the datasets not ended yet by the number beginDataset returned, and
+	 * the number of datasets begun so far ************************************/
+	map<size_t, OpenDataset> open_;
+	size_t numDatasets_ = 0;
+
+	/** guards the file, the index and the open datasets ***********************/
+	mutex mutex_;
+
+	/****************************************************************************
+	 ***************************************************************************/
+	void writeAt(const uint64_t offset, const void *data, const size_t size)
+	{
+		file_.seekp(offset);
+		file_.write(static_cast<const char *>(data), size);
+		if (!file_) {
+			cerr << "ERROR : COULD_NOT_WRITE_FILE : ";
+			cerr << "file = " << '"' << fileName_ << '"' << " : ";
+			cerr << "ResultStore::writeAt" << endl;
+			throw IoBinaryDataFileExcept(ERROR_COULD_NOT_WRITE_FILE);
+		}
+	}
+
+	/****************************************************************************
+	 * write the rows collected of a beta value into its blocks
+	 ***************************************************************************/
+	void flushTile(OpenDataset &dataset, const size_t b)
+	{
+		if (dataset.tileSize[b] == 0) {
+			return;
+		}
+		for (unsigned a = 0; a < RESULT_STORE_NUM_ALGORITHMS; a++) {
+			if (a == RESULT_STORE_TRUE && b > 0) {
+				continue;
+			}
+			const Entry &entry = index_[dataset.firstEntry + b * RESULT_STORE_NUM_ALGORITHMS + a];
+			for (unsigned c = 0; c < numColumns_; c++) {
+				writeAt(entry.offset + (c * dataset.numRows + dataset.tileFirst[b]) * sizeof(double),
+						&dataset.tiles[b][(a * RESULT_STORE_NUM_COLUMNS + c) * RESULT_STORE_TILE_ROWS],
+						dataset.tileSize[b] * sizeof(double));
+			}
+		}
+		if (b == 0) {
+			writeAt(index_[dataset.timeEntry].offset + dataset.tileFirst[b] * sizeof(double),
+					&dataset.tiles[b][RESULT_STORE_NUM_ALGORITHMS * RESULT_STORE_NUM_COLUMNS
+					* RESULT_STORE_TILE_ROWS], dataset.tileSize[b] * sizeof(double));
+		}
+		dataset.tileSize[b] = 0;
+	}
+
+	/****************************************************************************
+	 ***************************************************************************/
+	OpenDataset &getOpenDataset(const size_t dataset)
+	{
+		map<size_t, OpenDataset>::iterator p_dataset = open_.find(dataset);
+		if (p_dataset == open_.end()) {
+			cerr << "ERROR : DATASET_NOT_BEGUN : ";
+			cerr << "dataset = " << dataset << " : ";
+			cerr << "ResultStore::getOpenDataset" << endl;
+			throw IoBinaryDataFileExcept(ERROR_COULD_NOT_WRITE_FILE);
+		}
+		return p_dataset->second;
+	}
+
+public:
+	/****************************************************************************
+	 ***************************************************************************/
+	ResultStore()
+	{
+	}
+
+	/****************************************************************************
+	 ***************************************************************************/
+	~ResultStore()
+	{
+		try {
+			close();
+		}
+		catch (...) {
+		}
+	}
+
+	/****************************************************************************
+	 * create the file, an existing one is replaced. The Euler angles are
+	 * stored as well unless euler is false.
+	 ***************************************************************************/
+	void open(const string &fileName, const bool euler = true)
+	{
+		close();
+		fileName_ = fileName;
+		numColumns_ = euler ? RESULT_STORE_NUM_COLUMNS : RESULT_STORE_NUM_QUAT_COLUMNS;
+		file_.open(fileName.c_str(), ios::in | ios::out | ios::binary | ios::trunc);
+		if (!file_.is_open()) {
+			cerr << "ERROR : COULD_NOT_OPEN_FILE : ";
+			cerr << "file = " << '"' << fileName << '"' << " : ";
+			cerr << "ResultStore::open" << endl;
+			throw IoFileExcept(ERROR_COULD_NOT_OPEN_FILE);
+		}
+		index_.clear();
+		open_.clear();
+		numDatasets_ = 0;
+		end_ = sizeof(Header);
+		Header header = {};
+		writeAt(0, &header, sizeof(header));
+	}
+
+	/****************************************************************************
+	 ***************************************************************************/
+	bool isOpen() const
+	{
+		return file_.is_open();
+	}
+
+	/****************************************************************************
+	 * reserve the blocks of a dataset, samples firstSample up to
+	 * firstSample + numRows - 1 are stored for any beta value. The number
+	 * returned refers to the dataset until it is ended.
+	 ***************************************************************************/
+	size_t beginDataset(const string &dataset, const vector<double> &betas,
+			const unsigned long firstSample, const unsigned long numRows)
+	{
+		lock_guard<mutex> lock(mutex_);
+		OpenDataset &open = open_[numDatasets_];
+		size_t firstEntry = index_.size();
+		open.firstEntry = firstEntry;
+		open.firstSample = firstSample;
+		open.numRows = numRows;
+		for (size_t b = 0; b < betas.size(); b++) {
+			for (unsigned a = 0; a < RESULT_STORE_NUM_ALGORITHMS; a++) {
+				Entry entry = {};
+				strncpy(entry.dataset, dataset.c_str(), sizeof(entry.dataset) - 1);
+				entry.beta = CsvWriter::round(betas[b]);
+				entry.betaIndex = b;
+				entry.algorithm = a;
+				entry.numRows = numRows;
+				if (a == RESULT_STORE_TRUE && b > 0) {
+					entry.offset = index_[firstEntry + RESULT_STORE_TRUE].offset;
+					index_.push_back(entry);
+					continue;
+				}
+				entry.offset = end_;
+				end_ += numColumns_ * numRows * sizeof(double);
+				index_.push_back(entry);
+			}
+		}
+		Entry entry = {};
+		strncpy(entry.dataset, dataset.c_str(), sizeof(entry.dataset) - 1);
+		entry.algorithm = RESULT_STORE_TIME;
+		entry.numRows = numRows;
+		entry.offset = end_;
+		end_ += numRows * sizeof(double);
+		open.timeEntry = index_.size();
+		index_.push_back(entry);
+		open.tiles.assign(betas.size(), vector<double>((RESULT_STORE_NUM_ALGORITHMS
+				* RESULT_STORE_NUM_COLUMNS + 1) * RESULT_STORE_TILE_ROWS));
+		open.tileFirst.assign(betas.size(), 0);
+		open.tileSize.assign(betas.size(), 0);
+		return numDatasets_++;
+	}
+
+	/****************************************************************************
+	 * store a sample of beta value b of a dataset begun, taken at time
+	 * seconds, quat holds the quaternions {s, v1, v2,
+	 * v3} and euler the Euler angles of all algorithms one after another, the
+	 * true orientation and the time are taken from beta value 0 only, euler
+	 * is not used if the Euler angles are not stored
+	 ***************************************************************************/
+	void put(const size_t dataset, const size_t b, const unsigned long sample,
+			const double time, const double *quat, const double *euler)
+	{
+		lock_guard<mutex> lock(mutex_);
+		OpenDataset &open = getOpenDataset(dataset);
+		unsigned long row = sample - open.firstSample;
+		if (open.tileSize[b] > 0 && (row != open.tileFirst[b] + open.tileSize[b]
+				|| open.tileSize[b] == RESULT_STORE_TILE_ROWS)) {
+			flushTile(open, b);
+		}
+		if (open.tileSize[b] == 0) {
+			open.tileFirst[b] = row;
+		}
+		double *tile = open.tiles[b].data() + open.tileSize[b];
+		for (unsigned a = 0; a < RESULT_STORE_NUM_ALGORITHMS; a++) {
+			if (a == RESULT_STORE_TRUE && b > 0) {
+				continue;
+			}
+			for (unsigned c = 0; c < 4; c++) {
+				tile[(a * RESULT_STORE_NUM_COLUMNS + c) * RESULT_STORE_TILE_ROWS] = quat[4 * a + c];
+			}
+			for (unsigned c = 0; c + RESULT_STORE_NUM_QUAT_COLUMNS < numColumns_; c++) {
+				tile[(a * RESULT_STORE_NUM_COLUMNS + 4 + c) * RESULT_STORE_TILE_ROWS] = euler[3 * a + c];
+			}
+		}
+		tile[RESULT_STORE_NUM_ALGORITHMS * RESULT_STORE_NUM_COLUMNS * RESULT_STORE_TILE_ROWS] = time;
+		open.tileSize[b]++;
+	}
+
+	/****************************************************************************
+	 * write the rows of a dataset not written yet
+	 ***************************************************************************/
+	void endDataset(const size_t dataset)
+	{
+		lock_guard<mutex> lock(mutex_);
+		OpenDataset &open = getOpenDataset(dataset);
+		for (size_t b = 0; b < open.tiles.size(); b++) {
+			flushTile(open, b);
+		}
+		open_.erase(dataset);
+	}
+
+	/****************************************************************************
+	 * drop a dataset begun, e.g. of a run that has failed: its rows are not
+	 * written and its blocks are left out of the index, the space reserved
+	 * for them is left unused
+	 ***************************************************************************/
+	void abortDataset(const size_t dataset)
+	{
+		lock_guard<mutex> lock(mutex_);
+		OpenDataset &open = getOpenDataset(dataset);
+		size_t first = open.firstEntry;
+		size_t numEntries = open.timeEntry + 1 - first;
+		index_.erase(index_.begin() + first, index_.begin() + first + numEntries);
+		open_.erase(dataset);
+		for (pair<const size_t, OpenDataset> &p_open : open_) {
+			if (p_open.second.firstEntry > first) {
+				p_open.second.firstEntry -= numEntries;
+				p_open.second.timeEntry -= numEntries;
+			}
+		}
+	}
+
+	/****************************************************************************
+	 * append the index table, update the header and close the file
+	 ***************************************************************************/
+	void close()
+	{
+		if (!file_.is_open()) {
+			return;
+		}
+		while (!open_.empty()) {
+			endDataset(open_.begin()->first);
+		}
+		lock_guard<mutex> lock(mutex_);
+		Header header = {};
+		memcpy(header.magic, RESULT_STORE_MAGIC, sizeof(header.magic));
+		header.version = RESULT_STORE_VERSION;
+		header.entrySize = sizeof(Entry);
+		header.numColumns = numColumns_;
+		header.indexOffset = end_;
+		header.numEntries = index_.size();
+		if (!index_.empty()) {
+			writeAt(end_, index_.data(), index_.size() * sizeof(Entry));
+		}
+		writeAt(0, &header, sizeof(header));
+		file_.close();
+	}
+};
+
+static_assert(sizeof(ResultStore::Entry) == 64, "index entries take 64 bytes");
+static_assert(sizeof(ResultStore::Header) == 64, "the header takes 64 bytes");
+
+/**############################################################################
+# END OF FILE
+#############################################################################*/
+
+#endif /* __RESULTSTORE_H *****************************************************/
@@ -0,0 +1,135 @@
+/**############################################################################
+#
+# Description: A fixed size pool of worker threads
+#
+#
+# Copyright (C) 2024 by Hristina Radak
+#
+# Email: hristinaradak95@gmail.com
+#
+###############################################################################
+# Tasks are queued and run by a fixed number of worker threads. Each task
+# gets a future, thus the caller can wait for it and gets any exception the
+# task has thrown.
+#############################################################################*/
+
+#ifndef __THREADPOOL_H
+#define __THREADPOOL_H
+
+/**############################################################################
+# INCLUDES
+#############################################################################*/
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**############################################################################
+# NAMES
+#############################################################################*/
+
+using namespace std;
+
+/**############################################################################
+# CLASS DECLARATIONS
+#############################################################################*/
+
+/******************************************************************************
+ *****************************************************************************/
+class ThreadPool {
+
+	/** the worker threads *****************************************************/
+	vector<thread> workers_;
+
+	/** the tasks not started yet **********************************************/
+	deque<packaged_task<void()>> tasks_;
+
+	/** guards tasks_ and stop_ ************************************************/
+	mutex mutex_;
+	condition_variable condition_;
+	bool stop_ = false;
+
+	/****************************************************************************
+	 * run queued tasks until the pool is destroyed
+	 ***************************************************************************/
+	void work()
+	{
+		packaged_task<void()> task;
+		while (true) {
+			{
+				unique_lock<mutex> lock(mutex_);
+				condition_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+				if (tasks_.empty()) {
+					return;
+				}
+				task = move(tasks_.front());
+				tasks_.pop_front();
+			}
+			task();
+		}
+	}
+
+public:
+	/****************************************************************************
+	 * numThreads = 0 uses one thread per hardware thread
+	 ***************************************************************************/
+	ThreadPool(unsigned numThreads = 0)
+	{
+		if (numThreads == 0) {
+			numThreads = thread::hardware_concurrency();
+		}
+		if (numThreads == 0) {
+			numThreads = 1;
+		}
+		for (unsigned k = 0; k < numThreads; k++) {
+			workers_.emplace_back(&ThreadPool::work, this);
+		}
+	}
+
+	/****************************************************************************
+	 * queued tasks are finished before the workers are joined
+	 ***************************************************************************/
+	~ThreadPool()
+	{
+		{
+			lock_guard<mutex> lock(mutex_);
+			stop_ = true;
+		}
+		condition_.notify_all();
+		for (thread &worker : workers_) {
+			worker.join();
+		}
+	}
+
+	/****************************************************************************
+	 ***************************************************************************/
+	unsigned getNumThreads() const
+	{
+		return workers_.size();
+	}
+
+	/****************************************************************************
+	 * queue a task, the future returned gets ready once the task has finished
+	 ***************************************************************************/
+	future<void> submit(function<void()> function)
+	{
+		packaged_task<void()> task(move(function));
+		future<void> result = task.get_future();
+		{
+			lock_guard<mutex> lock(mutex_);
+			tasks_.push_back(move(task));
+		}
+		condition_.notify_one();
+		return result;
+	}
+};
+
+/**############################################################################
+# END OF FILE
+#############################################################################*/
+
+#endif /* __THREADPOOL_H ******************************************************/
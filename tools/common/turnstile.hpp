@@ -0,0 +1,83 @@
+/**############################################################################
+#
+# Description: Letting concurrent runs pass a section one after another
+#
+#
+# Copyright (C) 2024 by Hristina Radak
+#
+# Email: hristinaradak95@gmail.com
+#
+###############################################################################
+# Runs numbered 0, 1, 2, ... may work concurrently, but a section guarded by
+# a turnstile is passed by run k only after run k - 1 has passed it, thus
+# whatever is done in there (opening a dataset of a store, appending to a
+# shared file) happens in the same order as if the runs were done one by one.
+#############################################################################*/
+
+#ifndef __TURNSTILE_H
+#define __TURNSTILE_H
+
+/**############################################################################
+# INCLUDES
+#############################################################################*/
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+
+/**############################################################################
+# NAMES
+#############################################################################*/
+
+using namespace std;
+
+/**############################################################################
+# CLASS DECLARATIONS
+#############################################################################*/
+
+/******************************************************************************
+ *****************************************************************************/
+class Turnstile {
+
+	/** the run whose turn it is ***********************************************/
+	size_t next_ = 0;
+
+	/** guards next_ ***********************************************************/
+	mutex mutex_;
+	condition_variable condition_;
+
+public:
+	/****************************************************************************
+	 ***************************************************************************/
+	Turnstile()
+	{
+	}
+
+	/****************************************************************************
+	 * wait until all runs before run turn have passed
+	 ***************************************************************************/
+	void wait(const size_t turn)
+	{
+		unique_lock<mutex> lock(mutex_);
+		condition_.wait(lock, [this, turn]() { return next_ >= turn; });
+	}
+
+	/****************************************************************************
+	 * let the run after run turn pass, passing a turn twice does no harm
+	 ***************************************************************************/
+	void pass(const size_t turn)
+	{
+		{
+			lock_guard<mutex> lock(mutex_);
+			next_ = max(next_, turn + 1);
+		}
+		condition_.notify_all();
+	}
+};
+
+/**############################################################################
+# END OF FILE
+#############################################################################*/
+
+#endif /* __TURNSTILE_H *******************************************************/
@@ -0,0 +1,193 @@
+/**############################################################################
+#
+# Description: A pool of worker threads stealing tasks from each other
+#
+#
+# Copyright (C) 2024 by Hristina Radak
+#
+# Email: hristinaradak95@gmail.com
+#
+###############################################################################
+# Any worker has a queue of its own, tasks are handed to the queues in turn.
+# A worker runs the tasks of its own queue and, once it is empty, steals from
+# the queues of the others, thus no worker is idle while any task is left.
+# Tasks come with an estimate of their cost and any queue is kept ordered by
+# it, the most expensive task first, both for its owner and for thieves: the
+# longest jobs are started first and the short ones fill the gaps at the end.
+# Each task gets a future, as with ThreadPool.
+#############################################################################*/
+
+#ifndef __WORKSTEALINGPOOL_H
+#define __WORKSTEALINGPOOL_H
+
+/**############################################################################
+# INCLUDES
+#############################################################################*/
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**############################################################################
+# NAMES
+#############################################################################*/
+
+using namespace std;
+
+/**############################################################################
+# CLASS DECLARATIONS
+#############################################################################*/
+
+/******************************************************************************
+ *****************************************************************************/
+class WorkStealingPool {
+
+	/****************************************************************************
+	 ***************************************************************************/
+	struct Task {
+		double cost;
+		packaged_task<void()> task;
+	};
+
+	/****************************************************************************
+	 * the tasks of a worker, the most expensive one first
+	 ***************************************************************************/
+	struct Queue {
+		mutex mutex_;
+		deque<Task> tasks_;
+	};
+
+	/** the worker threads and their queues ************************************/
+	vector<thread> workers_;
+	vector<unique_ptr<Queue>> queues_;
+
+	/** the queue the next task is handed to ***********************************/
+	atomic<size_t> next_;
+
+	/** the number of tasks queued, may be off by the tasks being handed over,
+	 * and the idle workers waiting for it to get positive ********************/
+	atomic<long> numQueued_;
+	mutex idleMutex_;
+	condition_variable idle_;
+	bool stop_ = false;
+
+	/****************************************************************************
+	 * take the most expensive task of a queue, false if it is empty
+	 ***************************************************************************/
+	bool tryPop(Queue &queue, packaged_task<void()> &task)
+	{
+		lock_guard<mutex> lock(queue.mutex_);
+		if (queue.tasks_.empty()) {
+			return false;
+		}
+		task = move(queue.tasks_.front().task);
+		queue.tasks_.pop_front();
+		numQueued_--;
+		return true;
+	}
+
+	/****************************************************************************
+	 * run the tasks of queue w, steal those of the next queues once it is
+	 * empty, and wait for new ones once all are empty
+	 ***************************************************************************/
+	void work(const size_t w)
+	{
+		packaged_task<void()> task;
+		while (true) {
+			bool found = tryPop(*queues_[w], task);
+			for (size_t k = 1; !found && k < queues_.size(); k++) {
+				found = tryPop(*queues_[(w + k) % queues_.size()], task);
+			}
+			if (found) {
+				task();
+				continue;
+			}
+			unique_lock<mutex> lock(idleMutex_);
+			idle_.wait(lock, [this]() { return stop_ || numQueued_ > 0; });
+			if (stop_ && numQueued_ <= 0) {
+				return;
+			}
+		}
+	}
+
+public:
+	/****************************************************************************
+	 * numThreads = 0 uses one thread per hardware thread
+	 ***************************************************************************/
+	WorkStealingPool(unsigned numThreads = 0)
+	: next_(0), numQueued_(0)
+	{
+		if (numThreads == 0) {
+			numThreads = thread::hardware_concurrency();
+		}
+		if (numThreads == 0) {
+			numThreads = 1;
+		}
+		for (unsigned k = 0; k < numThreads; k++) {
+			queues_.emplace_back(new Queue());
+		}
+		for (unsigned k = 0; k < numThreads; k++) {
+			workers_.emplace_back(&WorkStealingPool::work, this, k);
+		}
+	}
+
+	/****************************************************************************
+	 * queued tasks are finished before the workers are joined
+	 ***************************************************************************/
+	~WorkStealingPool()
+	{
+		{
+			lock_guard<mutex> lock(idleMutex_);
+			stop_ = true;
+		}
+		idle_.notify_all();
+		for (thread &worker : workers_) {
+			worker.join();
+		}
+	}
+
+	/****************************************************************************
+	 ***************************************************************************/
+	unsigned getNumThreads() const
+	{
+		return workers_.size();
+	}
+
+	/****************************************************************************
+	 * queue a task of the given cost, it is started before any queued task
+	 * of lower cost of the same queue and after those of the same cost. The
+	 * future returned gets ready once the task has finished.
+	 ***************************************************************************/
+	future<void> submit(function<void()> function, const double cost = 0)
+	{
+		Task task = {cost, packaged_task<void()>(move(function))};
+		future<void> result = task.task.get_future();
+		Queue &queue = *queues_[next_++ % queues_.size()];
+		{
+			lock_guard<mutex> lock(queue.mutex_);
+			deque<Task>::iterator p_task = queue.tasks_.begin();
+			while (p_task != queue.tasks_.end() && p_task->cost >= cost) {
+				p_task++;
+			}
+			queue.tasks_.insert(p_task, move(task));
+		}
+		{
+			lock_guard<mutex> lock(idleMutex_);
+			numQueued_++;
+		}
+		idle_.notify_one();
+		return result;
+	}
+};
+
+/**############################################################################
+# END OF FILE
+#############################################################################*/
+
+#endif /* __WORKSTEALINGPOOL_H ************************************************/